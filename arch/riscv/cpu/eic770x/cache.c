@@ -20,8 +20,10 @@
 
 #include <common.h>
 #include <cpu_func.h>
+#include <stat.h>
 #include <asm/io.h>
 #include <asm/cache.h>
+#include <linux/errno.h>
 
 #define SIFIVE_L3_FLUSH64 0x200
 #define SIFIVE_L3_FLUSH64_LINE_LEN          64
@@ -33,13 +35,22 @@
 #define L3_DIE0_CTRL_BASE  0x2010000UL
 #define L3_DIE1_CTRL_BASE 0x22010000UL
 
-void sifive_l3_flush64_range(unsigned long start, unsigned long len)
+STAT_COUNTER_DEFINE(cache, l3_flushes);
+STAT_COUNTER_DEFINE(cache, l3_flush_lines);
+STAT_COUNTER_DEFINE(cache, l3_flush_skipped);
+
+/*
+ * Flush a range from the L3 cache of the die it belongs to
+ *
+ * Return: 0 if OK, -ERANGE if the range is not inside either die's window
+ */
+static int sifive_l3_flush(unsigned long start, unsigned long len)
 {
     unsigned long line;
     unsigned long l3_base = L3_DIE0_CTRL_BASE;
 
     if(!len)
-        return;
+        return 0;
 
     len = len + (start % SIFIVE_L3_FLUSH64_LINE_LEN);
     start = ALIGN_DOWN(start, SIFIVE_L3_FLUSH64_LINE_LEN);
@@ -57,16 +68,31 @@ void sifive_l3_flush64_range(unsigned long start, unsigned long len)
     }
     else
     {
-        // printf("L2CACHE: flush64 out of range: %lx(%lx), skip flush\n", start, len);
-        return;
+        STAT_INC(cache, l3_flush_skipped);
+        return -ERANGE;
     }
 
+    STAT_INC(cache, l3_flushes);
+    STAT_ADD(cache, l3_flush_lines, DIV_ROUND_UP(len, SIFIVE_L3_FLUSH64_LINE_LEN));
     for (line = start; line < start + len; line += SIFIVE_L3_FLUSH64_LINE_LEN)
     {
         writeq(line,(void __iomem*)(l3_base + SIFIVE_L3_FLUSH64));
         mb();
     }
+
+    return 0;
 }
+
+void sifive_l3_flush64_range(unsigned long start, unsigned long len)
+{
+    sifive_l3_flush(start, len);
+}
+
+int flush_dcache_range_check(unsigned long start, unsigned long end)
+{
+    return sifive_l3_flush(start, end - start);
+}
+
 void flush_dcache_all(void)
 {
 
@@ -80,4 +106,4 @@ void flush_dcache_range(unsigned long start, unsigned long end)
 void invalidate_dcache_range(unsigned long start, unsigned long end)
 {
     sifive_l3_flush64_range(start, end - start);
-}
\ No newline at end of file
+}
@@ -26,6 +26,8 @@ struct arch_global_data {
 #endif
 #if CONFIG_IS_ENABLED(SMP)
 	struct ipi_data ipi[CONFIG_NR_CPUS];
+	ulong smp_harts;	/* cached mask of secondary harts */
+	int smp_harts_valid;	/* smp_harts has been read from the DT */
 #endif
 #if !CONFIG_IS_ENABLED(XIP)
 #ifdef CONFIG_AVAILABLE_HARTS
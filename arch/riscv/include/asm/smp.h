@@ -29,12 +29,34 @@
  * @arg0: First argument of function
  * @arg1: Second argument of function
  * @valid: Whether this IPI is valid
+ * @busy: Whether the hart is still running a job from smp_job_submit()
  */
 struct ipi_data {
 	ulong addr;
 	ulong arg0;
 	ulong arg1;
 	unsigned int valid;
+	unsigned int busy;
+};
+
+/**
+ * struct smp_job - A function to run on one particular hart
+ *
+ * Jobs run on the secondary hart in its IPI handler, so @fn must not use the
+ * console or any driver. It can only allocate memory with
+ * CONFIG_SYS_MALLOC_CACHE, from chunks given to the hart by malloc_cache_fill().
+ * The structure must stay valid until the job is done.
+ *
+ * @fn: Function to run; it is passed the hart ID and @arg
+ * @arg: Argument for @fn
+ * @ret: Return value of @fn, valid once @done is set
+ * @done: Set to 1 by the hart once @fn has returned
+ */
+struct smp_job {
+	long (*fn)(ulong hart, void *arg);
+	void *arg;
+	long ret;
+	unsigned int done;
 };
 
 /**
@@ -60,6 +82,51 @@ void handle_ipi(ulong hart);
  */
 int smp_call_function(ulong addr, ulong arg0, ulong arg1, int wait);
 
+/**
+ * smp_get_harts() - Get the harts that U-Boot can send work to
+ *
+ * The enabled harts are read from the /cpus node the first time this is
+ * called and cached after that. The hart we are running on is not included.
+ *
+ * @hartsp: Returns a bitmask of hart IDs
+ * Return: 0 if OK, -ve on error
+ */
+int smp_get_harts(ulong *hartsp);
+
+/**
+ * smp_job_submit() - Run a job on one secondary hart
+ *
+ * This sends an IPI to @hart only, asking it to run @job. It does not wait
+ * for the job; use smp_job_done() or smp_job_wait() for that.
+ *
+ * @hart: Hart ID to run the job on
+ * @job: Job to run
+ * Return: 0 if OK, -ENODEV if @hart cannot take jobs, -EBUSY if it is still
+ * running a previous job, other -ve value on error
+ */
+int smp_job_submit(ulong hart, struct smp_job *job);
+
+/**
+ * smp_job_done() - Check whether a submitted job has finished
+ *
+ * @job: Job to check
+ * Return: true if the job has finished
+ */
+bool smp_job_done(struct smp_job *job);
+
+/**
+ * smp_job_wait() - Wait for a submitted job to finish
+ *
+ * If this times out, the hart may still be running the job, so @job must
+ * stay valid.
+ *
+ * @job: Job to wait for
+ * @timeout_ms: Time to wait in milliseconds
+ * Return: the value returned by the job function, or -ETIMEDOUT if the job
+ * did not finish in time
+ */
+long smp_job_wait(struct smp_job *job, ulong timeout_ms);
+
 /**
  * riscv_init_ipi() - Initialize inter-process interrupt (IPI) driver
  *
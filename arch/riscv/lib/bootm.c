@@ -12,6 +12,7 @@
 #include <fdt_support.h>
 #include <hang.h>
 #include <log.h>
+#include <profile.h>
 #include <asm/global_data.h>
 #include <dm/root.h>
 #include <image.h>
@@ -38,6 +39,8 @@ static void announce_and_cleanup(int fake)
 	printf("\nStarting kernel ...%s\n\n", fake ?
 		"(fake run for tracing)" : "");
 	bootstage_mark_name(BOOTSTAGE_ID_BOOTM_HANDOFF, "start_kernel");
+	if (IS_ENABLED(CONFIG_PROFILE))
+		profile_stop();
 #ifdef CONFIG_BOOTSTAGE_FDT
 	bootstage_fdt_add_report();
 #endif
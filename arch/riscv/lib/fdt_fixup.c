@@ -48,7 +48,7 @@ int riscv_fdt_copy_resv_mem_node(const void *src, void *dst)
 	 * Each PMP memory region entry occupies 64 bytes.
 	 * With 16 PMP memory regions we need 64 * 16 = 1024 bytes.
 	 */
-	err = fdt_open_into(dst, dst, fdt_totalsize(dst) + 1024);
+	err = fdt_ensure_space(dst, 1024);
 	if (err < 0) {
 		printf("Device Tree can't be expanded to accommodate new node");
 		return err;
@@ -144,11 +144,9 @@ int arch_fixup_fdt(void *blob)
 {
 	int err;
 #ifdef CONFIG_EFI_LOADER
-	u32 size;
 	int chosen_offset;
 
-	size = fdt_totalsize(blob);
-	err  = fdt_open_into(blob, blob, size + 32);
+	err = fdt_ensure_space(blob, 32);
 	if (err < 0) {
 		log_err("Device Tree can't be expanded to accommodate new node");
 		return err;
@@ -197,7 +197,9 @@ ulong handle_trap(ulong cause, ulong epc, ulong tval, struct pt_regs *regs)
 			break;
 		case IRQ_M_TIMER:
 		case IRQ_S_TIMER:
-			timer_interrupt(0);	/* handle timer interrupt */
+			/* the trap entry leaves this slot free for the epc */
+			regs->sepc = epc;
+			timer_interrupt(regs);	/* handle timer interrupt */
 			break;
 		default:
 			_exit_trap(cause, epc, tval, regs);
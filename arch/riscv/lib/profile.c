@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling-profiler timer, using the supervisor timer programmed via the SBI
+ */
+
+#include <common.h>
+#include <irq_func.h>
+#include <profile.h>
+#include <asm/csr.h>
+#include <asm/ptrace.h>
+#include <asm/sbi.h>
+#include <dm/ofnode.h>
+#include <linux/errno.h>
+
+/* Number of timer ticks between samples, or 0 if not profiling */
+static ulong profile_ticks;
+
+int arch_profile_start(ulong period_us)
+{
+	u32 rate;
+
+	if (ofnode_read_u32(ofnode_path("/cpus"), "timebase-frequency", &rate))
+		return -ENOENT;
+	profile_ticks = max_t(u64, (u64)period_us * rate / 1000000, 1);
+
+	sbi_set_timer(csr_read(CSR_TIME) + profile_ticks);
+	csr_set(CSR_SIE, SIE_STIE);
+	csr_set(CSR_SSTATUS, SR_SIE);
+
+	return 0;
+}
+
+void arch_profile_stop(void)
+{
+	csr_clear(CSR_SSTATUS, SR_SIE);
+	csr_clear(CSR_SIE, SIE_STIE);
+	profile_ticks = 0;
+	sbi_set_timer(-1ULL);
+}
+
+void timer_interrupt(struct pt_regs *regs)
+{
+	if (!profile_ticks) {
+		/* not ours; push the deadline out so it does not fire again */
+		sbi_set_timer(-1ULL);
+		return;
+	}
+	profile_sample(regs->sepc);
+	sbi_set_timer(csr_read(CSR_TIME) + profile_ticks);
+}
@@ -6,18 +6,29 @@
 
 #include <cpu_func.h>
 #include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
 #include <asm/barrier.h>
 #include <asm/global_data.h>
 #include <asm/smp.h>
+#include <linux/bitops.h>
+#include <linux/errno.h>
 #include <linux/printk.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
-static int send_ipi_many(struct ipi_data *ipi, int wait)
+int smp_get_harts(ulong *hartsp)
 {
 	ofnode node, cpus;
+	ulong harts = 0;
 	u32 reg;
-	int ret, pending;
+	int ret;
+
+	if (gd->arch.smp_harts_valid) {
+		*hartsp = gd->arch.smp_harts;
+		return 0;
+	}
 
 	cpus = ofnode_path("/cpus");
 	if (!ofnode_valid(cpus)) {
@@ -45,45 +56,86 @@ static int send_ipi_many(struct ipi_data *ipi, int wait)
 			continue;
 		}
 
+		harts |= BIT(reg);
+	}
+
+	gd->arch.smp_harts = harts;
+	gd->arch.smp_harts_valid = 1;
+	*hartsp = harts;
+
+	return 0;
+}
+
+/* Check whether a hart has reached U-Boot and can take IPIs */
+static bool smp_hart_available(int reg)
+{
 #if !CONFIG_IS_ENABLED(XIP)
 #ifdef CONFIG_AVAILABLE_HARTS
-		/* skip if hart is not available */
-		if (!(gd->arch.available_harts & (1 << reg)))
-			continue;
+	if (!(gd->arch.available_harts & (1 << reg)))
+		return false;
 #endif
 #endif
+	return true;
+}
 
-		gd->arch.ipi[reg].addr = ipi->addr;
-		gd->arch.ipi[reg].arg0 = ipi->arg0;
-		gd->arch.ipi[reg].arg1 = ipi->arg1;
-
-		/*
-		 * Ensure valid only becomes set when the IPI parameters are
-		 * set. An IPI may already be pending on other harts, so we
-		 * need a way to signal that the IPI device has been
-		 * initialized, and that it is ok to call the function.
-		 */
-		__smp_store_release(&gd->arch.ipi[reg].valid, 1);
-
-		ret = riscv_send_ipi(reg);
-		if (ret) {
-			pr_err("Cannot send IPI to hart %d\n", reg);
-			return ret;
-		}
+static int send_ipi(int reg, struct ipi_data *ipi, int wait)
+{
+	int ret, pending;
+
+	/* skip if hart is not available */
+	if (!smp_hart_available(reg))
+		return 0;
+
+	gd->arch.ipi[reg].addr = ipi->addr;
+	gd->arch.ipi[reg].arg0 = ipi->arg0;
+	gd->arch.ipi[reg].arg1 = ipi->arg1;
 
-		if (wait) {
-			pending = 1;
-			while (pending) {
-				ret = riscv_get_ipi(reg, &pending);
-				if (ret)
-					return ret;
-			}
+	/*
+	 * Ensure valid only becomes set when the IPI parameters are
+	 * set. An IPI may already be pending on other harts, so we
+	 * need a way to signal that the IPI device has been
+	 * initialized, and that it is ok to call the function.
+	 */
+	__smp_store_release(&gd->arch.ipi[reg].valid, 1);
+
+	ret = riscv_send_ipi(reg);
+	if (ret) {
+		pr_err("Cannot send IPI to hart %d\n", reg);
+		return ret;
+	}
+
+	if (wait) {
+		pending = 1;
+		while (pending) {
+			ret = riscv_get_ipi(reg, &pending);
+			if (ret)
+				return ret;
 		}
 	}
 
 	return 0;
 }
 
+static int send_ipi_many(struct ipi_data *ipi, int wait)
+{
+	ulong harts;
+	int ret, reg;
+
+	ret = smp_get_harts(&harts);
+	if (ret)
+		return ret;
+
+	for (reg = 0; reg < CONFIG_NR_CPUS; reg++) {
+		if (!(harts & BIT(reg)))
+			continue;
+		ret = send_ipi(reg, ipi, wait);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
 void handle_ipi(ulong hart)
 {
 	int ret;
@@ -126,3 +178,94 @@ int smp_call_function(ulong addr, ulong arg0, ulong arg1, int wait)
 
 	return send_ipi_many(&ipi, wait);
 }
+
+static void smp_job_run(ulong hart, ulong arg0, ulong arg1)
+{
+	struct smp_job *job = (struct smp_job *)arg0;
+
+	job->ret = job->fn(hart, job->arg);
+	/* Free the hart first, so it can take a new job once this one is done */
+	__smp_store_release(&gd->arch.ipi[hart].busy, 0);
+	__smp_store_release(&job->done, 1);
+}
+
+int smp_job_submit(ulong hart, struct smp_job *job)
+{
+	struct ipi_data ipi = {
+		.addr = (ulong)smp_job_run,
+		.arg0 = (ulong)job,
+	};
+	ulong harts;
+	int ret;
+
+	ret = smp_get_harts(&harts);
+	if (ret)
+		return ret;
+	if (hart >= CONFIG_NR_CPUS || !(harts & BIT(hart)) ||
+	    !smp_hart_available(hart))
+		return -ENODEV;
+	if (__smp_load_acquire(&gd->arch.ipi[hart].busy))
+		return -EBUSY;
+
+	job->ret = 0;
+	job->done = 0;
+	gd->arch.ipi[hart].busy = 1;
+	ret = send_ipi(hart, &ipi, 0);
+	if (ret)
+		gd->arch.ipi[hart].busy = 0;
+
+	return ret;
+}
+
+bool smp_job_done(struct smp_job *job)
+{
+	return __smp_load_acquire(&job->done);
+}
+
+long smp_job_wait(struct smp_job *job, ulong timeout_ms)
+{
+	ulong start = get_timer(0);
+
+	while (!smp_job_done(job)) {
+		if (get_timer(start) > timeout_ms)
+			return -ETIMEDOUT;
+	}
+
+	return job->ret;
+}
+
+/* The hart ID is kept in tp while U-Boot runs */
+static __maybe_unused ulong smp_hart_id(void)
+{
+	ulong hart;
+
+	asm volatile ("mv %0, tp" : "=r"(hart));
+
+	return hart;
+}
+
+#if CONFIG_IS_ENABLED(LOG_RING)
+/* Each hart logs to its own ring */
+uint log_ring_cpu(void)
+{
+	return smp_hart_id();
+}
+
+bool log_ring_secondary(void)
+{
+	return smp_hart_id() != gd->arch.boot_hart;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+/* Each hart has its own malloc() cache, so jobs can allocate from it */
+uint malloc_cache_cpu(void)
+{
+	return smp_hart_id();
+}
+
+bool malloc_cache_secondary(void)
+{
+	return smp_hart_id() != gd->arch.boot_hart;
+}
+#endif
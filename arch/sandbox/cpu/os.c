@@ -349,6 +349,28 @@ int os_setup_signal_handlers(void)
 	return 0;
 }
 
+int os_profile_timer(unsigned long period_us)
+{
+	struct itimerval timer;
+	struct sigaction act;
+
+	memset(&timer, '\0', sizeof(timer));
+	if (period_us) {
+		act.sa_sigaction = os_signal_handler;
+		sigemptyset(&act.sa_mask);
+		act.sa_flags = SA_SIGINFO | SA_RESTART;
+		if (sigaction(SIGPROF, &act, NULL))
+			return -errno;
+		timer.it_interval.tv_sec = period_us / 1000000;
+		timer.it_interval.tv_usec = period_us % 1000000;
+		timer.it_value = timer.it_interval;
+	}
+	if (setitimer(ITIMER_PROF, &timer, NULL))
+		return -errno;
+
+	return 0;
+}
+
 /* Put tty into raw mode so <tab> and <ctrl+c> work */
 void os_tty_raw(int fd, bool allow_sigs)
 {
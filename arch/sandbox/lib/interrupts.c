@@ -9,6 +9,7 @@
 #include <efi_loader.h>
 #include <irq_func.h>
 #include <os.h>
+#include <profile.h>
 #include <asm/global_data.h>
 #include <asm-generic/signal.h>
 #include <asm/u-boot-sandbox.h>
@@ -29,10 +30,26 @@ int disable_interrupts(void)
 	return 0;
 }
 
+int arch_profile_start(ulong period_us)
+{
+	return os_profile_timer(period_us);
+}
+
+void arch_profile_stop(void)
+{
+	os_profile_timer(0);
+}
+
 void os_signal_action(int sig, unsigned long pc)
 {
 	efi_restore_gd();
 
+	if (sig == SIGPROF) {
+		if (IS_ENABLED(CONFIG_PROFILE))
+			profile_sample(pc);
+		return;
+	}
+
 	switch (sig) {
 	case SIGILL:
 		printf("\nIllegal instruction\n");
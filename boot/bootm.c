@@ -19,6 +19,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <net.h>
+#include <profile.h>
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -72,6 +73,10 @@ static inline void boot_start_lmb(struct bootm_headers *images) { }
 static int bootm_start(struct cmd_tbl *cmdtp, int flag, int argc,
 		       char *const argv[])
 {
+#ifdef CONFIG_LMB
+	/* Free the regions left from a previous bootm */
+	lmb_uninit(&images.lmb);
+#endif
 	memset((void *)&images, 0, sizeof(images));
 	images.verify = env_get_yesno("verify");
 
@@ -486,6 +491,8 @@ ulong bootm_disable_interrupts(void)
 	 * overwrite all exception vector code, so we cannot easily
 	 * recover from any failures any more...
 	 */
+	if (IS_ENABLED(CONFIG_PROFILE))
+		profile_stop();
 	iflag = disable_interrupts();
 #ifdef CONFIG_NETCONSOLE
 	/* Stop the ethernet stack if NetConsole could have left it up */
@@ -821,6 +821,27 @@ int fdt_increase_size(void *fdt, int add_len)
 	return fdt_open_into(fdt, fdt, newlen);
 }
 
+int fdt_ensure_space(void *fdt, int len)
+{
+	int rsv_end, struct_end, end;
+	int ret;
+
+	ret = fdt_check_header(fdt);
+	if (ret)
+		return ret;
+
+	rsv_end = fdt_off_mem_rsvmap(fdt) +
+		(fdt_num_mem_rsv(fdt) + 1) * sizeof(struct fdt_reserve_entry);
+	struct_end = fdt_off_dt_struct(fdt) + fdt_size_dt_struct(fdt);
+	end = fdt_off_dt_strings(fdt) + fdt_size_dt_strings(fdt);
+	if (fdt_version(fdt) >= 17 && fdt_off_dt_struct(fdt) >= rsv_end &&
+	    fdt_off_dt_strings(fdt) >= struct_end &&
+	    fdt_totalsize(fdt) >= end + len)
+		return 0;
+
+	return fdt_increase_size(fdt, len);
+}
+
 #ifdef CONFIG_FDT_FIXUP_PARTITIONS
 #include <jffs2/load_kernel.h>
 #include <mtd_node.h>
@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <fdt_support.h>
 #include <fdtdec.h>
 #include <env.h>
@@ -611,6 +612,7 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob,
 	int ret = -EPERM;
 	int fdt_ret;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_FDT_FIXUP, "fdt_fixup");
 	if (fdt_root(blob) < 0) {
 		printf("ERROR: root node setup failed\n");
 		goto err;
@@ -643,6 +645,7 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob,
 	/* Append PStore configuration */
 	fdt_fixup_pstore(blob);
 #endif
+	bootstage_start(BOOTSTAGE_ID_ACCUM_FDT_BOARD, "ft_board_setup");
 	if (IS_ENABLED(CONFIG_OF_BOARD_SETUP)) {
 		const char *skip_board_fixup;
 
@@ -654,7 +657,7 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob,
 			if (fdt_ret) {
 				printf("ERROR: board-specific fdt fixup failed: %s\n",
 				       fdt_strerror(fdt_ret));
-				goto err;
+				goto err_board;
 			}
 		}
 	}
@@ -663,7 +666,7 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob,
 		if (fdt_ret) {
 			printf("ERROR: system-specific fdt fixup failed: %s\n",
 			       fdt_strerror(fdt_ret));
-			goto err;
+			goto err_board;
 		}
 	}
 	if (!of_live_active() && CONFIG_IS_ENABLED(EVENT)) {
@@ -676,10 +679,11 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob,
 			if (ret) {
 				printf("ERROR: fdt fixup event failed: %d\n",
 				       ret);
-				goto err;
+				goto err_board;
 			}
 		}
 	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_BOARD);
 
 	/* Delete the old LMB reservation */
 	if (lmb)
@@ -707,9 +711,13 @@ int image_setup_libfdt(struct bootm_headers *images, void *blob,
 	if (IS_ENABLED(CONFIG_OF_BOARD_SETUP))
 		ft_board_setup_ex(blob, gd->bd);
 #endif
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 
 	return 0;
+err_board:
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_BOARD);
 err:
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_FDT_FIXUP);
 	printf(" - must RESET the board to recover.\n\n");
 
 	return ret;
@@ -27,6 +27,7 @@
 
 #include <splash.h>
 #include <asm/io.h>
+#include <u-boot/crc.h>
 
 #include "menu.h"
 #include "cli.h"
@@ -83,6 +84,94 @@ int format_mac_pxe(char *outbuf, size_t outbuf_len)
 	return 1;
 }
 
+/**
+ * pxe_file_find() - Find a file which is still in memory
+ *
+ * @ctx: PXE context
+ * @path: Full path of the file
+ * @file_addr: Address the file is wanted at
+ * Return: file record if the file was read to @file_addr and is unchanged,
+ *	else NULL
+ */
+static struct pxe_file *pxe_file_find(struct pxe_context *ctx,
+				      const char *path, ulong file_addr)
+{
+	struct pxe_file *file;
+	const void *buf;
+	u32 crc;
+
+	list_for_each_entry(file, &ctx->files, sibling) {
+		if (file->addr != file_addr || strcmp(file->path, path))
+			continue;
+		buf = map_sysmem(file->addr, file->size);
+		crc = crc32(0, buf, file->size);
+		unmap_sysmem(buf);
+
+		return crc == file->crc ? file : NULL;
+	}
+
+	return NULL;
+}
+
+/**
+ * pxe_file_add() - Record a file which has just been read
+ *
+ * Any files which were overwritten by this one are dropped. Failure to record
+ * the file is not an error, since it just means that it is fetched again if
+ * needed.
+ *
+ * @ctx: PXE context
+ * @path: Full path of the file
+ * @file_addr: Address the file was read to
+ * @size: Size of the file in bytes
+ */
+static void pxe_file_add(struct pxe_context *ctx, const char *path,
+			 ulong file_addr, ulong size)
+{
+	struct pxe_file *file, *next;
+	const void *buf;
+
+	list_for_each_entry_safe(file, next, &ctx->files, sibling) {
+		if (file->addr < file_addr + size &&
+		    file_addr < file->addr + file->size) {
+			list_del(&file->sibling);
+			free(file->path);
+			free(file);
+		}
+	}
+
+	file = malloc(sizeof(*file));
+	if (!file)
+		return;
+	file->path = strdup(path);
+	if (!file->path) {
+		free(file);
+		return;
+	}
+	file->addr = file_addr;
+	file->size = size;
+	buf = map_sysmem(file_addr, size);
+	file->crc = crc32(0, buf, size);
+	unmap_sysmem(buf);
+	list_add_tail(&file->sibling, &ctx->files);
+}
+
+/**
+ * pxe_file_drop_all() - Forget all files which have been read
+ *
+ * @ctx: PXE context
+ */
+static void pxe_file_drop_all(struct pxe_context *ctx)
+{
+	struct pxe_file *file, *next;
+
+	list_for_each_entry_safe(file, next, &ctx->files, sibling) {
+		list_del(&file->sibling);
+		free(file->path);
+		free(file);
+	}
+}
+
 /**
  * get_relfile() - read a file relative to the PXE file
  *
@@ -121,6 +210,18 @@ static int get_relfile(struct pxe_context *ctx, const char *file_path,
 
 	strcat(relfile, file_path);
 
+	if (IS_ENABLED(CONFIG_PXE_FILE_CACHE)) {
+		struct pxe_file *file = pxe_file_find(ctx, relfile, file_addr);
+
+		if (file) {
+			printf("Reusing file: %s\n", relfile);
+			env_set_hex("filesize", file->size);
+			if (filesizep)
+				*filesizep = file->size;
+			return 1;
+		}
+	}
+
 	printf("Retrieving file: %s\n", relfile);
 
 	sprintf(addr_buf, "%lx", file_addr);
@@ -130,6 +231,8 @@ static int get_relfile(struct pxe_context *ctx, const char *file_path,
 		return log_msg_ret("get", ret);
 	if (filesizep)
 		*filesizep = size;
+	if (IS_ENABLED(CONFIG_PXE_FILE_CACHE))
+		pxe_file_add(ctx, relfile, file_addr, size);
 
 	return 1;
 }
@@ -1589,6 +1692,7 @@ int pxe_setup_ctx(struct pxe_context *ctx, struct cmd_tbl *cmdtp,
 	ctx->userdata = userdata;
 	ctx->allow_abs_path = allow_abs_path;
 	ctx->use_ipv6 = use_ipv6;
+	INIT_LIST_HEAD(&ctx->files);
 
 	/* figure out the boot directory, if there is one */
 	if (bootfile && strlen(bootfile) >= MAX_TFTP_PATH_LEN)
@@ -1609,6 +1713,7 @@ int pxe_setup_ctx(struct pxe_context *ctx, struct cmd_tbl *cmdtp,
 
 void pxe_destroy_ctx(struct pxe_context *ctx)
 {
+	pxe_file_drop_all(ctx);
 	free(ctx->bootdir);
 }
 
@@ -1628,6 +1733,7 @@ int pxe_process(struct pxe_context *ctx, ulong pxefile_addr_r, bool prompt)
 	handle_pxe_menu(ctx, cfg);
 
 	destroy_pxe_menu(cfg);
+	pxe_file_drop_all(ctx);
 
 	return 0;
 }
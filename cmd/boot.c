@@ -10,6 +10,7 @@
 #include <common.h>
 #include <command.h>
 #include <net.h>
+#include <profile.h>
 
 #ifdef CONFIG_CMD_GO
 
@@ -34,6 +35,10 @@ static int do_go(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 	printf ("## Starting application at 0x%08lX ...\n", addr);
 	flush();
 
+	/* The application may take over the timer and trap vector */
+	if (IS_ENABLED(CONFIG_PROFILE))
+		profile_stop();
+
 	/*
 	 * pass address parameter as argv[0] (aka command name),
 	 * and all remaining args
@@ -6,6 +6,8 @@
 #include <common.h>
 #include <bootstage.h>
 #include <command.h>
+#include <env.h>
+#include <mapmem.h>
 
 static int do_bootstage_report(struct cmd_tbl *cmdtp, int flag, int argc,
 			       char *const argv[])
@@ -59,10 +61,37 @@ static int do_bootstage_stash(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_bootstage_json(struct cmd_tbl *cmdtp, int flag, int argc,
+			     char *const argv[])
+{
+	ulong addr, size;
+	char *buf;
+	int len;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	addr = hextoul(argv[1], NULL);
+	size = hextoul(argv[2], NULL);
+
+	buf = map_sysmem(addr, size);
+	len = bootstage_export_json(buf, size);
+	unmap_sysmem(buf);
+	if (len >= size) {
+		printf("Need %#x bytes for output, only %#lx available\n",
+		       len + 1, size);
+		return CMD_RET_FAILURE;
+	}
+	printf("Wrote %#x bytes of trace-event JSON\n", len);
+	env_set_hex("filesize", len);
+
+	return 0;
+}
+
 static struct cmd_tbl cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+	U_BOOT_CMD_MKENT(json, 4, 0, do_bootstage_json, "", ""),
 };
 
 /*
@@ -92,5 +121,6 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
-	"unstash [<start> [<size>]]  - Unstash data from memory"
+	"unstash [<start> [<size>]]  - Unstash data from memory\n"
+	"json <start> <size>         - Write trace-event JSON to memory"
 );
@@ -98,6 +98,7 @@ static int esburn_init_load_addr(uint64_t addr, uint64_t size)
 	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
 
 	max_size = lmb_get_free_size(&lmb, addr);
+	lmb_uninit(&lmb);
 	if (!max_size || max_size < size)
 		return -1;
 #endif
@@ -220,45 +221,137 @@ int es_spi_flash_probe(u32 num)
 }
 
 #define BOOTCHAIN_PACKAGE_SIZE (0x100000ul)
-static int es_spi_flash_erase(uint64_t offset, uint64_t size)
+
+/*
+ * Bring one window of flash to the contents of @want. @cur holds what the
+ * flash currently contains. Sectors that already match are left alone,
+ * sectors that only need bits cleared are programmed without an erase (NOR
+ * programming can only turn 1s into 0s), and runs of sectors that do need
+ * an erase are issued as a single spi_flash_erase() so the driver can use
+ * its largest erase opcode wherever the run is aligned. Only pages that
+ * differ are programmed, coalesced into as few writes as possible.
+ */
+static int es_spi_flash_update_window(uint64_t offset, const u8 *want, u8 *cur,
+				      size_t len, size_t *erased, size_t *written)
 {
+	u32 sect = flash->erase_size;
+	u32 page = flash->page_size;
+	size_t pos, run_start, run_len, i;
 	int ret;
-	uint64_t package_blk, total_size, erase_size, currentIndex = 0;
 
-	debug_printf("offset : %llx, size %llx  flash->size %x\n",offset, size, flash->size);
-	total_size = DIV_ROUND_UP(size, 0x1000)*0x1000;
-	debug_printf("offset : %llx, size %llx\n",offset, size);
+	run_len = 0;
+	run_start = 0;
+	for (pos = 0; pos <= len; pos += sect) {
+		bool need_erase = false;
+
+		if (pos < len && memcmp(cur + pos, want + pos, sect)) {
+			for (i = pos; i < pos + sect; i++) {
+				if ((cur[i] & want[i]) != want[i]) {
+					need_erase = true;
+					break;
+				}
+			}
+		}
+		if (need_erase) {
+			if (!run_len)
+				run_start = pos;
+			run_len += sect;
+			continue;
+		}
+		if (run_len) {
+			ret = spi_flash_erase(flash, offset + run_start, run_len);
+			if (ret)
+				return ret;
+			memset(cur + run_start, 0xff, run_len);
+			*erased += run_len;
+			run_len = 0;
+		}
+	}
 
-	package_blk = DIV_ROUND_UP(total_size, BOOTCHAIN_PACKAGE_SIZE);  /* blkcnt */
-	printf("Erase progress: %3d%%:\r", 0);
-	for(int i = 0;i < package_blk; i++) {
-		if(total_size > BOOTCHAIN_PACKAGE_SIZE)
-		{
-			erase_size = BOOTCHAIN_PACKAGE_SIZE;
-		} else {
-			erase_size = total_size;
+	run_len = 0;
+	run_start = 0;
+	for (pos = 0; pos <= len; pos += page) {
+		if (pos < len && memcmp(cur + pos, want + pos, page)) {
+			if (!run_len)
+				run_start = pos;
+			run_len += page;
+			continue;
 		}
-		total_size -= BOOTCHAIN_PACKAGE_SIZE;
-		ret = spi_flash_erase(flash, offset + i*BOOTCHAIN_PACKAGE_SIZE, erase_size);
-		currentIndex = (uint64_t)i * 100 / package_blk;
-		printf("Erase progress: %3lld%%:", currentIndex);
-		for(int col = 0; col < currentIndex/2; col++) {
-			printf("%s","+");
+		if (run_len) {
+			ret = spi_flash_write(flash, offset + run_start, run_len,
+					      want + run_start);
+			if (ret)
+				return ret;
+			*written += run_len;
+			run_len = 0;
 		}
-		printf("\r");
-		if(ret)
-			break;
 	}
-	if(!ret) {
-		printf("Erase progress: %3d%%:", 100);
-		for(int j = 0; j < 100/2; j ++)
-			printf("%s","+");
-		printf("\r\n");
+
+	return 0;
+}
+
+/*
+ * Update [offset, offset + size) with the data at @src, only erasing and
+ * programming what actually changes. The range is widened to whole erase
+ * sectors; bytes outside the requested range keep their current contents.
+ */
+static int es_spi_flash_update(const u8 *src, uint64_t offset, uint64_t size)
+{
+	uint64_t start, end, pos, currentIndex;
+	size_t win, erased = 0, written = 0;
+	u8 *cur, *want;
+	int ret = 0;
+
+	start = ALIGN_DOWN(offset, flash->erase_size);
+	end = ALIGN(offset + size, flash->erase_size);
+	if (end > flash->size) {
+		printf("ERROR: attempting past flash size (%#x)\r\n",
+		       flash->size);
+		return -EINVAL;
 	}
-	printf("SF: %zu bytes @ %#x Erased: %s\r\n", (size_t)size, (uint32_t)offset,
-		   ret ? "ERROR" : "OK");
 
-	return ret == 0 ? 0 : 1;
+	cur = memalign(ARCH_DMA_MINALIGN, BOOTCHAIN_PACKAGE_SIZE);
+	want = memalign(ARCH_DMA_MINALIGN, BOOTCHAIN_PACKAGE_SIZE);
+	if (!cur || !want) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	printf("Write progress: %3d%%:\r", 0);
+	for (pos = start; pos < end; pos += win) {
+		uint64_t lo, hi;
+
+		win = min_t(uint64_t, end - pos, BOOTCHAIN_PACKAGE_SIZE);
+		ret = spi_flash_read(flash, pos, win, cur);
+		if (ret)
+			goto out;
+
+		/* Merge the new data over the current window contents */
+		memcpy(want, cur, win);
+		lo = max(pos, offset);
+		hi = min(pos + win, offset + size);
+		memcpy(want + (lo - pos), src + (lo - offset), hi - lo);
+
+		ret = es_spi_flash_update_window(pos, want, cur, win, &erased,
+						 &written);
+		if (ret)
+			goto out;
+
+		currentIndex = (pos + win - start) * 100 / (end - start);
+		printf("Write progress: %3lld%%:", currentIndex);
+		for (int col = 0; col < currentIndex / 2; col++)
+			printf("%s", "+");
+		printf("\r");
+	}
+	printf("\r\n");
+	printf("SF: %zu bytes erased, %zu bytes written, %zu bytes unchanged\r\n",
+	       erased, written, (size_t)(end - start) - written);
+
+out:
+	free(want);
+	free(cur);
+
+	return ret;
 }
 
 int norflash_read_bootchain(uint64_t dst_addr, uint64_t offset, uint64_t size)
@@ -281,67 +374,37 @@ int norflash_read_bootchain(uint64_t dst_addr, uint64_t offset, uint64_t size)
 
 static int norflash_write_bootchain(uint64_t src_addr, uint64_t offset, uint64_t size)
 {
-	int ret = 1;
+	int ret;
 	uint32_t retry_count = 3;
-	uint64_t package_blk, total_size, write_size, currentIndex = 0;
 	uint32_t crc_raw = crc32(0, (void *)src_addr, size);
+	uint32_t crc_flash;
+	char *cmp_buf;
 
 	debug_printf("src_addr %llx offset : %llx, size %llx\r\n",src_addr, offset, size);
-retry:
-	es_bootspi_wp_cfg(flash, 0);
-	ret = es_spi_flash_erase(offset, size);
-	if(ret) {
-		es_bootspi_wp_cfg(flash, 1);
-		return ret;
-	}
-	package_blk = DIV_ROUND_UP(size, BOOTCHAIN_PACKAGE_SIZE); 
-	total_size = size;
-	printf("\rWrite progress: %3d%%:\r", 0);
-	for(int i = 0;i < package_blk; i++) {
-		if(total_size > BOOTCHAIN_PACKAGE_SIZE)
-		{
-			write_size = BOOTCHAIN_PACKAGE_SIZE;
-		} else {
-			write_size = total_size;
-		}
-		total_size -= BOOTCHAIN_PACKAGE_SIZE;
-		ret = spi_flash_write(flash, offset + i * BOOTCHAIN_PACKAGE_SIZE, write_size,
-				      (void *)(src_addr + i * BOOTCHAIN_PACKAGE_SIZE));
-		currentIndex = (uint64_t)i * 100 / package_blk;
-		printf("Write progress: %3lld%%:", currentIndex);
-		for(int col = 0; col < currentIndex/2; col++) {
-			printf("%s","+");
-		}
-		printf("\r");
-		if(ret)
-			goto out;
+	cmp_buf = memalign(ARCH_DMA_MINALIGN, size);
+	if (!cmp_buf) {
+		printf("check crc32 error!!!\r\n");
+		return 1;
 	}
 
-	char *cmp_buf = memalign(ARCH_DMA_MINALIGN, size);
-	if (cmp_buf) {
-		ret = spi_flash_read(flash, offset, size, (void *)cmp_buf);
-		if(ret)
-			goto out;
-		uint32_t crc_flash = crc32(0, cmp_buf, size);
-		if(crc_flash != crc_raw) {
-			retry_count--;
-			ret = -1;
-			printf("cmdbuf %x %x %x %x %x\r\n", cmp_buf[0],cmp_buf[1],cmp_buf[2],cmp_buf[3],cmp_buf[4]);
-			if(retry_count)
-				goto retry;
-		}
-	} else {
-		printf("check crc32 error!!!\r\n");
-		ret = -1;
+	es_bootspi_wp_cfg(flash, 0);
+retry:
+	ret = es_spi_flash_update((const u8 *)src_addr, offset, size);
+	if (ret)
 		goto out;
-	}
 
-	if(!ret) {
-		printf("Write progress: %3d%%:", 100);
-		for(int j = 0; j < 100/2; j ++)
-			printf("%s","+");
-		printf("\r\n");
+	ret = spi_flash_read(flash, offset, size, (void *)cmp_buf);
+	if (ret)
+		goto out;
+	crc_flash = crc32(0, cmp_buf, size);
+	if (crc_flash != crc_raw) {
+		retry_count--;
+		ret = -1;
+		printf("cmdbuf %x %x %x %x %x\r\n", cmp_buf[0],cmp_buf[1],cmp_buf[2],cmp_buf[3],cmp_buf[4]);
+		if (retry_count)
+			goto retry;
 	}
+
 out:
 	printf("SF: 0x%lx bytes @ %#x Written: %s\r\n",
 		(size_t)size, (uint32_t)offset, ret?"ERROR":"OK");
@@ -7,9 +7,11 @@
 #include <common.h>
 #include <command.h>
 #include <dm.h>
+#include <env.h>
 #include <getopt.h>
 #include <log.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <asm/global_data.h>
 
 static char log_fmt_chars[LOGF_COUNT] = "clFLfm";
@@ -375,6 +377,36 @@ static int do_log_rec(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_log_dump(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	ulong addr, size;
+	char *buf;
+	int len;
+
+	if (!CONFIG_IS_ENABLED(LOG_RING)) {
+		printf("Log ring not enabled\n");
+		return CMD_RET_FAILURE;
+	}
+	if (argc == 1) {
+		log_ring_show();
+		return 0;
+	}
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	addr = hextoul(argv[1], NULL);
+	size = hextoul(argv[2], NULL);
+
+	buf = map_sysmem(addr, size);
+	len = log_ring_export(buf, size);
+	if (len >= size)
+		printf("Log truncated, %#x bytes needed\n", len + 1);
+	env_set_hex("filesize", strnlen(buf, size));
+	unmap_sysmem(buf);
+
+	return 0;
+}
+
 U_BOOT_LONGHELP(log,
 	"level [<level>] - get/set log level\n"
 	"categories - list log categories\n"
@@ -404,7 +436,9 @@ U_BOOT_LONGHELP(log,
 	"\tc=category, l=level, F=file, L=line number, f=function, m=msg\n"
 	"\tor 'default', or 'all' for all\n"
 	"log rec <category> <level> <file> <line> <func> <message> - "
-		"output a log record");
+		"output a log record\n"
+	"log dump [<addr> <size>] - format the records in the log ring and\n"
+	"\tprint them, or write them to memory and set 'filesize'");
 
 U_BOOT_CMD_WITH_SUBCMDS(log, "log system", log_help_text,
 	U_BOOT_SUBCMD_MKENT(level, 2, 1, do_log_level),
@@ -416,4 +450,5 @@ U_BOOT_CMD_WITH_SUBCMDS(log, "log system", log_help_text,
 	U_BOOT_SUBCMD_MKENT(filter-remove, 4, 1, do_log_filter_remove),
 	U_BOOT_SUBCMD_MKENT(format, 2, 1, do_log_format),
 	U_BOOT_SUBCMD_MKENT(rec, 7, 1, do_log_rec),
+	U_BOOT_SUBCMD_MKENT(dump, 3, 1, do_log_dump),
 );
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show heap usage
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static uint malloc_percent(ulong part, ulong whole)
+{
+	return whole ? part * 100ULL / whole : 0;
+}
+
+static int do_malloc_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	struct malloc_info info;
+
+	malloc_get_info(&info);
+	printf("total        = %#010lx\n", info.total);
+	printf("in use       = %#010lx (%u%%)\n", info.in_use,
+	       malloc_percent(info.in_use, info.total));
+	printf("peak         = %#010lx (%u%%)\n", info.peak,
+	       malloc_percent(info.peak, info.total));
+	printf("free         = %#010lx in %lu chunks and the top\n", info.free,
+	       info.free_chunks);
+	printf("largest free = %#010lx\n", info.largest_free);
+	printf("fragmented   = %u%%\n",
+	       malloc_percent(info.free - info.largest_free, info.free));
+	if (IS_ENABLED(CONFIG_SYS_MALLOC_CACHE)) {
+		printf("cached       = %#010lx in %lu chunks\n", info.cached,
+		       info.cached_chunks);
+		printf("cache hits   = %lu of %lu\n", info.cache_hits,
+		       info.cache_hits + info.cache_misses);
+	}
+#if CONFIG_IS_ENABLED(SYS_MALLOC_F)
+	printf("pre-reloc    = %#010lx of %#010lx\n", gd->malloc_ptr,
+	       (ulong)CONFIG_VAL(SYS_MALLOC_F_LEN));
+#endif
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(malloc,
+	"stats - show heap usage, peak and fragmentation");
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "Heap information", malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(stats, 1, 1, do_malloc_stats));
@@ -16,14 +16,17 @@
 #include <cli.h>
 #include <command.h>
 #include <console.h>
+#include <cpu_func.h>
 #include <display_options.h>
 #ifdef CONFIG_MTD_NOR_FLASH
 #include <flash.h>
 #endif
 #include <hash.h>
 #include <log.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <rand.h>
+#include <time.h>
 #include <watchdog.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -31,6 +34,14 @@
 #include <linux/compiler.h>
 #include <linux/ctype.h>
 #include <linux/delay.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
+
+#if defined(CONFIG_CMD_MEMTEST_PARALLEL) && defined(CONFIG_RISCV) && \
+	CONFIG_IS_ENABLED(SMP)
+#include <asm/smp.h>
+#define MTEST_SMP
+#endif
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -1060,6 +1071,530 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+#ifdef CONFIG_CMD_MEMTEST_PARALLEL
+/* Number of failing addresses recorded by each hart in each phase */
+#define MTEST_MAX_ERRS		4
+
+#ifdef MTEST_SMP
+#define MTEST_MAX_WORKERS	CONFIG_NR_CPUS
+
+/*
+ * A hart which has not finished a phase after this long is taken to be stuck.
+ * This allows 1 second plus 100ms for each MB that the hart tests.
+ */
+#define MTEST_TIMEOUT_MS	1000
+#define MTEST_TIMEOUT_MS_PER_MB	100
+#else
+#define MTEST_MAX_WORKERS	1
+#endif
+
+/**
+ * enum mtest_phase - One pass over memory in the parallel test
+ *
+ * @MTEST_ADDR_WRITE: Write each word's own address into it
+ * @MTEST_ADDR_INVERT: Check each word holds its address, then invert it
+ * @MTEST_ADDR_CHECK: Check each word holds its inverted address
+ * @MTEST_FILL: Write the pattern to every word
+ * @MTEST_UP: Going up, check for the pattern then write its inverse
+ * @MTEST_DOWN: Going down, check for the inverse then write the pattern
+ * @MTEST_CHECK: Check for the pattern
+ */
+enum mtest_phase {
+	MTEST_ADDR_WRITE,
+	MTEST_ADDR_INVERT,
+	MTEST_ADDR_CHECK,
+	MTEST_FILL,
+	MTEST_UP,
+	MTEST_DOWN,
+	MTEST_CHECK,
+
+	MTEST_PHASE_COUNT,
+};
+
+/**
+ * struct mtest_part - Part of a DRAM bank tested by one worker
+ *
+ * @addr: Address of the first word
+ * @buf: @addr mapped into U-Boot's address space
+ * @count: Number of words
+ * @unflushed: true once the caches have failed to flush this part
+ */
+struct mtest_part {
+	ulong addr;
+	vu_long *buf;
+	ulong count;
+	bool unflushed;
+};
+
+/**
+ * struct mtest_worker - Work done by one hart in the parallel test
+ *
+ * Secondary harts must not use the console, so each records the first few
+ * errors and the coordinating hart reports them once the phase is done.
+ *
+ * @hart: Hart ID, or -1UL if the work is done on the coordinating hart
+ * @part: Parts of the range to test, at most one in each DRAM bank
+ * @nparts: Number of parts
+ * @phase: Phase to run
+ * @pattern: Pattern to use for the moving-inversions phases
+ * @errs: Number of errors found in this phase
+ * @err_addr: Addresses of the first errors found in this phase
+ * @err_found: Values found at those addresses
+ * @err_expect: Values expected at those addresses
+ * @bytes: Total bytes read and written
+ * @us: Total time taken in microseconds
+ * @job: Job used to run the phase on @hart
+ * @running: true while @job is running
+ */
+struct mtest_worker {
+	ulong hart;
+	struct mtest_part part[CONFIG_NR_DRAM_BANKS + 1];
+	int nparts;
+	enum mtest_phase phase;
+	ulong pattern;
+	ulong errs;
+	ulong err_addr[MTEST_MAX_ERRS];
+	ulong err_found[MTEST_MAX_ERRS];
+	ulong err_expect[MTEST_MAX_ERRS];
+	u64 bytes;
+	u64 us;
+#ifdef MTEST_SMP
+	struct smp_job job;
+	bool running;
+#endif
+};
+
+/**
+ * struct mtest_ctx - State of the parallel test
+ *
+ * @worker: Workers, one for each hart taking part
+ * @nworkers: Number of workers
+ * @flush: true to flush the caches between phases, so that every read is
+ *	served from DRAM rather than from the cache
+ * @stuck: true if a hart did not finish a phase. It may still be using the
+ *	context, so it must not be freed.
+ */
+struct mtest_ctx {
+	struct mtest_worker worker[MTEST_MAX_WORKERS];
+	int nworkers;
+	bool flush;
+	bool stuck;
+};
+
+static void mtest_error(struct mtest_worker *wkr, const struct mtest_part *part,
+			vu_long *addr, ulong found, ulong expect)
+{
+	if (wkr->errs < MTEST_MAX_ERRS) {
+		wkr->err_addr[wkr->errs] = part->addr +
+			(addr - part->buf) * sizeof(ulong);
+		wkr->err_found[wkr->errs] = found;
+		wkr->err_expect[wkr->errs] = expect;
+	}
+	wkr->errs++;
+}
+
+/**
+ * mtest_run_part() - Run a phase of the parallel test on part of the range
+ *
+ * @wkr: Worker running the phase
+ * @part: Part to test
+ * Return: number of bytes read and written
+ */
+static ulong mtest_run_part(struct mtest_worker *wkr,
+			    const struct mtest_part *part)
+{
+	const ulong pat = wkr->pattern;
+	vu_long *end = part->buf + part->count;
+	ulong addr = part->addr;
+	ulong bytes = part->count * sizeof(ulong);
+	vu_long *ptr;
+	ulong val;
+
+	switch (wkr->phase) {
+	case MTEST_ADDR_WRITE:
+		for (ptr = part->buf; ptr < end; ptr++, addr += sizeof(ulong))
+			*ptr = addr;
+		return bytes;
+	case MTEST_ADDR_INVERT:
+		for (ptr = part->buf; ptr < end; ptr++, addr += sizeof(ulong)) {
+			val = *ptr;
+			if (val != addr)
+				mtest_error(wkr, part, ptr, val, addr);
+			*ptr = ~addr;
+		}
+		return bytes * 2;
+	case MTEST_ADDR_CHECK:
+		for (ptr = part->buf; ptr < end; ptr++, addr += sizeof(ulong)) {
+			val = *ptr;
+			if (val != ~addr)
+				mtest_error(wkr, part, ptr, val, ~addr);
+		}
+		return bytes;
+	case MTEST_FILL:
+		for (ptr = part->buf; ptr < end; ptr++)
+			*ptr = pat;
+		return bytes;
+	case MTEST_UP:
+		for (ptr = part->buf; ptr < end; ptr++) {
+			val = *ptr;
+			if (val != pat)
+				mtest_error(wkr, part, ptr, val, pat);
+			*ptr = ~pat;
+		}
+		return bytes * 2;
+	case MTEST_DOWN:
+		for (ptr = end; ptr-- > part->buf;) {
+			val = *ptr;
+			if (val != ~pat)
+				mtest_error(wkr, part, ptr, val, ~pat);
+			*ptr = pat;
+		}
+		return bytes * 2;
+	case MTEST_CHECK:
+		for (ptr = part->buf; ptr < end; ptr++) {
+			val = *ptr;
+			if (val != pat)
+				mtest_error(wkr, part, ptr, val, pat);
+		}
+		return bytes;
+	default:
+		return 0;
+	}
+}
+
+static long mtest_run_phase(ulong hart, void *arg)
+{
+	struct mtest_worker *wkr = arg;
+	int i;
+
+	for (i = 0; i < wkr->nparts; i++)
+		wkr->bytes += mtest_run_part(wkr, &wkr->part[i]);
+
+	return 0;
+}
+
+/**
+ * mtest_add_region() - Split a region between the workers
+ *
+ * Each worker gets a part of similar size, aligned to 4KB where possible so
+ * that parts do not share cache lines.
+ *
+ * @ctx: Test context
+ * @start: Start address of the region
+ * @end: End address of the region (exclusive)
+ */
+static void mtest_add_region(struct mtest_ctx *ctx, ulong start, ulong end)
+{
+	ulong size, addr;
+	int i;
+
+	size = ALIGN(DIV_ROUND_UP(end - start, ctx->nworkers), SZ_4K);
+	for (i = 0, addr = start; i < ctx->nworkers && addr < end; i++) {
+		struct mtest_worker *wkr = &ctx->worker[i];
+		struct mtest_part *part = &wkr->part[wkr->nparts++];
+		ulong len = min(size, end - addr);
+
+		part->addr = addr;
+		part->count = len / sizeof(ulong);
+		part->buf = map_sysmem(addr, len);
+		addr += len;
+	}
+}
+
+/**
+ * mtest_find_bank() - Find how far a memory range stays in or out of DRAM
+ *
+ * @addr: Start address to look at
+ * @end: End of the range (exclusive)
+ * @nextp: Returns the end of the DRAM bank holding @addr, or the start of the
+ *	next bank if @addr is not in one; never beyond @end
+ * Return: true if @addr is in a DRAM bank, else false
+ */
+static bool mtest_find_bank(ulong addr, ulong end, ulong *nextp)
+{
+	int i;
+
+	*nextp = end;
+	for (i = 0; i < CONFIG_NR_DRAM_BANKS; i++) {
+		ulong bank_start = gd->bd->bi_dram[i].start;
+		ulong bank_end = bank_start + gd->bd->bi_dram[i].size;
+
+		if (!gd->bd->bi_dram[i].size)
+			continue;
+		if (addr >= bank_start && addr < bank_end) {
+			*nextp = min(end, bank_end);
+			return true;
+		}
+		if (bank_start > addr && bank_start < *nextp)
+			*nextp = bank_start;
+	}
+
+	return false;
+}
+
+/**
+ * mtest_setup() - Set up the parallel test
+ *
+ * The range is split at the edges of the DRAM banks, so that the parts never
+ * span a hole between banks (e.g. between the memory of two dies). If the
+ * range is not in any bank it is tested as given. If it is partly in the
+ * banks, the parts which are not are shown and the test is refused, since
+ * they would otherwise be skipped without notice.
+ *
+ * @ctx: Context to set up
+ * @start: Start address of the range
+ * @end: End address of the range (exclusive)
+ * @flush: true to flush the caches between phases
+ * Return: 0 if OK, -ERANGE if the range is only partly in the DRAM banks
+ */
+static int mtest_setup(struct mtest_ctx *ctx, ulong start, ulong end,
+		       bool flush)
+{
+	bool found = false, gap = false;
+	ulong addr, next;
+
+	memset(ctx, '\0', sizeof(*ctx));
+	ctx->flush = flush;
+	ctx->nworkers = 1;
+	ctx->worker[0].hart = -1UL;
+#ifdef MTEST_SMP
+	{
+		ulong harts, hart;
+
+		/* leave this hart free to run the console and report */
+		if (!smp_get_harts(&harts) && harts) {
+			ctx->nworkers = 0;
+			for (hart = 0; hart < CONFIG_NR_CPUS; hart++) {
+				if (harts & BIT(hart))
+					ctx->worker[ctx->nworkers++].hart = hart;
+			}
+		}
+	}
+#endif
+	start = ALIGN(start, sizeof(ulong));
+	end = ALIGN_DOWN(end, sizeof(ulong));
+	for (addr = start; addr < end; addr = next) {
+		if (mtest_find_bank(addr, end, &next)) {
+			mtest_add_region(ctx, addr, next);
+			found = true;
+		} else {
+			gap = true;
+		}
+	}
+	if (!found) {
+		if (start < end)
+			mtest_add_region(ctx, start, end);
+		return 0;
+	}
+	if (!gap)
+		return 0;
+
+	for (addr = start; addr < end; addr = next) {
+		if (!mtest_find_bank(addr, end, &next))
+			printf("%08lx ... %08lx is not in DRAM\n", addr, next - 1);
+	}
+
+	return -ERANGE;
+}
+
+static void mtest_uninit(struct mtest_ctx *ctx)
+{
+	int i, j;
+
+	for (i = 0; i < ctx->nworkers; i++) {
+		struct mtest_worker *wkr = &ctx->worker[i];
+
+		for (j = 0; j < wkr->nparts; j++)
+			unmap_sysmem((void *)wkr->part[j].buf);
+	}
+}
+
+__weak int flush_dcache_range_check(unsigned long start, unsigned long stop)
+{
+	flush_dcache_range(start, stop);
+
+	return 0;
+}
+
+/**
+ * mtest_phase() - Run one phase of the parallel test on all workers
+ *
+ * The harts cannot be stopped once they have started a phase, so if ctrl-c is
+ * pressed this waits for them to finish before returning. A hart which does
+ * not finish in time fails the test.
+ *
+ * @ctx: Test context
+ * @phase: Phase to run
+ * @pattern: Pattern to use
+ * Return: number of errors found, or -1 if interrupted or a hart is stuck
+ */
+static ulong mtest_phase(struct mtest_ctx *ctx, enum mtest_phase phase,
+			 ulong pattern)
+{
+	const int plen = 2 * sizeof(ulong);
+	ulong start, errs = 0;
+	bool interrupted = false;
+	int i, j;
+#ifdef MTEST_SMP
+	ulong base, timeout = 0;
+	int busy = 0;
+#endif
+
+	for (i = 0; i < ctx->nworkers; i++) {
+		struct mtest_worker *wkr = &ctx->worker[i];
+
+		wkr->phase = phase;
+		wkr->pattern = pattern;
+		wkr->errs = 0;
+	}
+
+	start = timer_get_us();
+#ifdef MTEST_SMP
+	for (i = 0; i < ctx->nworkers; i++) {
+		struct mtest_worker *wkr = &ctx->worker[i];
+		ulong bytes = 0;
+
+		if (wkr->hart == -1UL)
+			continue;
+		for (j = 0; j < wkr->nparts; j++)
+			bytes += wkr->part[j].count * sizeof(ulong);
+		timeout = max(timeout, MTEST_TIMEOUT_MS +
+			      bytes / SZ_1M * MTEST_TIMEOUT_MS_PER_MB);
+		wkr->job.fn = mtest_run_phase;
+		wkr->job.arg = wkr;
+		wkr->running = !smp_job_submit(wkr->hart, &wkr->job);
+		if (wkr->running) {
+			busy++;
+		} else {
+			/* do the work here instead */
+			printf("\nHart %lu is not responding\n", wkr->hart);
+			wkr->hart = -1UL;
+		}
+	}
+#endif
+	for (i = 0; i < ctx->nworkers; i++) {
+		struct mtest_worker *wkr = &ctx->worker[i];
+
+		if (wkr->hart == -1UL) {
+			mtest_run_phase(0, wkr);
+			wkr->us += timer_get_us() - start;
+		}
+	}
+#ifdef MTEST_SMP
+	/* note when each hart finishes, to work out its bandwidth */
+	base = get_timer(0);
+	while (busy) {
+		for (i = 0; i < ctx->nworkers; i++) {
+			struct mtest_worker *wkr = &ctx->worker[i];
+
+			if (wkr->running && smp_job_done(&wkr->job)) {
+				wkr->us += timer_get_us() - start;
+				wkr->running = false;
+				busy--;
+			}
+		}
+		if (!busy)
+			break;
+		if (!interrupted && ctrlc()) {
+			printf("\nWaiting for the harts to finish\n");
+			interrupted = true;
+		}
+		if (get_timer(base) > timeout) {
+			for (i = 0; i < ctx->nworkers; i++) {
+				struct mtest_worker *wkr = &ctx->worker[i];
+
+				if (wkr->running)
+					printf("\nHart %lu did not finish\n",
+					       wkr->hart);
+			}
+			ctx->stuck = true;
+			return -1UL;
+		}
+		schedule();
+	}
+#endif
+
+	for (i = 0; i < ctx->nworkers; i++) {
+		struct mtest_worker *wkr = &ctx->worker[i];
+
+		for (j = 0; j < min(wkr->errs, (ulong)MTEST_MAX_ERRS); j++) {
+			printf("\nMem error @ 0x%0*lX: found %0*lX, expected %0*lX, bits %0*lX\n",
+			       plen, wkr->err_addr[j], plen, wkr->err_found[j],
+			       plen, wkr->err_expect[j], plen,
+			       wkr->err_found[j] ^ wkr->err_expect[j]);
+		}
+		if (wkr->errs > MTEST_MAX_ERRS)
+			printf("... and %lu more\n", wkr->errs - MTEST_MAX_ERRS);
+		errs += wkr->errs;
+
+		if (ctx->flush) {
+			for (j = 0; j < wkr->nparts; j++) {
+				struct mtest_part *part = &wkr->part[j];
+
+				ulong end = part->addr +
+					part->count * sizeof(ulong);
+
+				if (flush_dcache_range_check(part->addr, end) &&
+				    !part->unflushed) {
+					printf("\nCannot flush %08lx ... %08lx from the cache\n",
+					       part->addr, end);
+					part->unflushed = true;
+				}
+			}
+		}
+	}
+
+	return interrupted ? -1UL : errs;
+}
+
+/**
+ * mem_test_parallel() - Run one iteration of the parallel test
+ *
+ * This writes each word's address into it and checks it, then runs a
+ * moving-inversions test with @pattern, which is flipped on odd iterations
+ * as with the quick test.
+ *
+ * @ctx: Test context
+ * @pattern: Pattern to use
+ * @iteration: Iteration number
+ * Return: number of errors found, or -1 if interrupted
+ */
+static ulong mem_test_parallel(struct mtest_ctx *ctx, ulong pattern,
+			       int iteration)
+{
+	ulong errs = 0;
+	int phase;
+
+	if (iteration & 1)
+		pattern = ~pattern;
+	for (phase = 0; phase < MTEST_PHASE_COUNT; phase++) {
+		ulong phase_errs = mtest_phase(ctx, phase, pattern);
+
+		if (phase_errs == -1UL || ctrlc())
+			return -1UL;
+		errs += phase_errs;
+	}
+
+	return errs;
+}
+
+static void mtest_show_bandwidth(struct mtest_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < ctx->nworkers; i++) {
+		struct mtest_worker *wkr = &ctx->worker[i];
+		ulong mbps = wkr->us ? div64_u64(wkr->bytes, wkr->us) : 0;
+
+		if (wkr->hart == -1UL)
+			printf("main: ");
+		else
+			printf("hart %lu: ", wkr->hart);
+		printf("%lu.%02lu GB/s\n", mbps / 1000, mbps % 1000 / 10);
+	}
+}
+#endif /* CONFIG_CMD_MEMTEST_PARALLEL */
+
 /*
  * Perform a memory test. A more complete alternative test can be
  * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
@@ -1076,6 +1611,26 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 	ulong errs = 0;	/* number of errors, or -1 if interrupted */
 	ulong pattern = 0;
 	int iteration;
+#ifdef CONFIG_CMD_MEMTEST_PARALLEL
+	struct mtest_ctx *ctx = NULL;
+	bool parallel = false;
+	bool flush = false;
+
+	for (; argc > 1 && *argv[1] == '-'; argc--, argv++) {
+		const char *p;
+
+		for (p = argv[1] + 1; *p; p++) {
+			if (*p == 'p')
+				parallel = true;
+			else if (*p == 'c')
+				flush = true;
+			else
+				return CMD_RET_USAGE;
+		}
+	}
+	if (flush && !parallel)
+		return CMD_RET_USAGE;
+#endif
 
 	start = CONFIG_SYS_MEMTEST_START;
 	end = CONFIG_SYS_MEMTEST_END;
@@ -1105,6 +1660,21 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 	debug("%s:%d: start %#08lx end %#08lx\n", __func__, __LINE__,
 	      start, end);
 
+#ifdef CONFIG_CMD_MEMTEST_PARALLEL
+	if (parallel) {
+		ctx = malloc(sizeof(*ctx));
+		if (!ctx)
+			return CMD_RET_FAILURE;
+		if (mtest_setup(ctx, start, end, flush)) {
+			mtest_uninit(ctx);
+			free(ctx);
+			return CMD_RET_FAILURE;
+		}
+		printf("Using %d hart(s)%s\n", ctx->nworkers,
+		       flush ? ", flushing caches" : "");
+	}
+#endif
+
 	buf = map_sysmem(start, end - start);
 	for (iteration = 0;
 			!iteration_limit || iteration < iteration_limit;
@@ -1116,6 +1686,15 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 
 		printf("Iteration: %6d\r", iteration + 1);
 		debug("\n");
+#ifdef CONFIG_CMD_MEMTEST_PARALLEL
+		if (ctx) {
+			errs = mem_test_parallel(ctx, pattern, iteration);
+			if (errs == -1UL)
+				break;
+			count += errs;
+			continue;
+		}
+#endif
 		if (IS_ENABLED(CONFIG_SYS_ALT_MEMTEST)) {
 			errs = mem_test_alt(buf, start, end, dummy);
 			if (errs == -1UL)
@@ -1136,6 +1715,14 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 	unmap_sysmem((void *)buf);
 
 	printf("\nTested %d iteration(s) with %lu errors.\n", iteration, count);
+#ifdef CONFIG_CMD_MEMTEST_PARALLEL
+	/* a stuck hart may still write to the context, so leave it */
+	if (ctx && !ctx->stuck) {
+		mtest_show_bandwidth(ctx);
+		mtest_uninit(ctx);
+		free(ctx);
+	}
+#endif
 
 	return errs != 0;
 }
@@ -1417,9 +2004,17 @@ U_BOOT_CMD(
 
 #ifdef CONFIG_CMD_MEMTEST
 U_BOOT_CMD(
-	mtest,	5,	1,	do_mem_mtest,
+	mtest,	7,	1,	do_mem_mtest,
 	"simple RAM read/write test",
+#ifdef CONFIG_CMD_MEMTEST_PARALLEL
+	"[-p [-c]] "
+#endif
 	"[start [end [pattern [iterations]]]]"
+#ifdef CONFIG_CMD_MEMTEST_PARALLEL
+	"\n  -p: split the test across harts, using address and\n"
+	"      moving-inversions patterns, and show the bandwidth\n"
+	"  -c: flush the caches after each pass so reads come from DRAM"
+#endif
 );
 #endif	/* CONFIG_CMD_MEMTEST */
 
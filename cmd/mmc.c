@@ -133,7 +133,9 @@ static void print_mmcinfo(struct mmc *mmc)
 static struct mmc *__init_mmc_device(int dev, bool force_init,
 				     enum bus_mode speed_mode)
 {
+	struct blk_desc *bd;
 	struct mmc *mmc;
+
 	mmc = find_mmc_device(dev);
 	if (!mmc) {
 		printf("no mmc device at slot %x\n", dev);
@@ -152,10 +154,11 @@ static struct mmc *__init_mmc_device(int dev, bool force_init,
 	if (mmc_init(mmc))
 		return NULL;
 
+	bd = mmc_get_blk_desc(mmc);
 #ifdef CONFIG_BLOCK_CACHE
-	struct blk_desc *bd = mmc_get_blk_desc(mmc);
 	blkcache_invalidate(bd->uclass_id, bd->devnum);
 #endif
+	part_efi_cache_invalidate(bd);
 
 	return mmc;
 }
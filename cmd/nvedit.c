@@ -847,12 +847,15 @@ sep_err:
 
 #ifdef CONFIG_CMD_IMPORTENV
 /*
- * env import [-d] [-t [-r] | -b | -c] addr [size] [var ...]
+ * env import [-d] [-u] [-t [-r] | -b | -c] addr [size] [var ...]
  *	-d:	delete existing environment before importing if no var is
  *		passed; if vars are passed, if one var is in the current
  *		environment but not in the environment at addr, delete var from
  *		current environment;
  *		otherwise overwrite / append to existing definitions
+ *	-u:	only update variables whose value changes; with -d, delete
+ *		the variables missing from the imported environment instead
+ *		of clearing the whole environment first
  *	-t:	assume text format; either "size" must be given or the
  *		text data must be '\0' terminated
  *	-r:	handle CRLF like LF, that means exported variables with
@@ -879,6 +882,7 @@ static int do_env_import(struct cmd_tbl *cmdtp, int flag,
 	int	chk = 0;
 	int	fmt = 0;
 	int	del = 0;
+	int	diff = 0;
 	int	crlf_is_lf = 0;
 	int	wl = 0;
 	size_t	size;
@@ -911,6 +915,9 @@ static int do_env_import(struct cmd_tbl *cmdtp, int flag,
 			case 'd':
 				del = 1;
 				break;
+			case 'u':
+				diff = 1;
+				break;
 			default:
 				return CMD_RET_USAGE;
 			}
@@ -975,7 +982,8 @@ static int do_env_import(struct cmd_tbl *cmdtp, int flag,
 		ptr = (char *)ep->data;
 	}
 
-	if (!himport_r(&env_htab, ptr, size, sep, del ? 0 : H_NOCLEAR,
+	if (!himport_r(&env_htab, ptr, size, sep,
+		       (del ? 0 : H_NOCLEAR) | (diff ? H_DIFF : 0),
 		       crlf_is_lf, wl ? argc - 2 : 0, wl ? &argv[2] : NULL)) {
 		pr_err("## Error: Environment import failed: errno = %d\n",
 		       errno);
@@ -1268,7 +1276,7 @@ U_BOOT_LONGHELP(env,
 #endif
 #endif
 #if defined(CONFIG_CMD_IMPORTENV)
-	"env import [-d] [-t [-r] | -b | -c] addr [size] [var ...] - import environment\n"
+	"env import [-d] [-u] [-t [-r] | -b | -c] addr [size] [var ...] - import environment\n"
 #endif
 #if defined(CONFIG_CMD_NVEDIT_INDIRECT)
 	"env indirect <to> <from> [default] - sets <to> to the value of <from>, using [default] when unset\n"
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Control the sampling profiler
+ */
+
+#include <common.h>
+#include <command.h>
+#include <errno.h>
+#include <profile.h>
+#include <vsprintf.h>
+
+enum {
+	PROFILE_DEFAULT_PERIOD_US	= 1000,
+	PROFILE_DEFAULT_FUNCS		= 20,
+};
+
+static int do_profile_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	ulong period_us = PROFILE_DEFAULT_PERIOD_US;
+	int ret;
+
+	if (argc > 1)
+		period_us = dectoul(argv[1], NULL);
+	if (!period_us)
+		return CMD_RET_USAGE;
+
+	ret = profile_start(period_us);
+	if (ret) {
+		printf("Cannot start profiler (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_profile_stop(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	profile_stop();
+
+	return 0;
+}
+
+static int do_profile_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	uint max_funcs = PROFILE_DEFAULT_FUNCS;
+	int ret;
+
+	if (argc > 1)
+		max_funcs = dectoul(argv[1], NULL);
+
+	ret = profile_show(max_funcs);
+	if (ret == -EBUSY) {
+		printf("Profiler is running; use 'profile stop' first\n");
+		return CMD_RET_FAILURE;
+	} else if (ret) {
+		printf("Cannot show profile (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(profile,
+	"start [<period_us>] - start sampling, every <period_us> (default 1000)\n"
+	"profile stop                - stop sampling\n"
+	"profile show [<count>]      - show the <count> busiest functions (default 20)");
+
+U_BOOT_CMD_WITH_SUBCMDS(profile, "Sampling profiler", profile_help_text,
+	U_BOOT_SUBCMD_MKENT(start, 2, 1, do_profile_start),
+	U_BOOT_SUBCMD_MKENT(stop, 1, 1, do_profile_stop),
+	U_BOOT_SUBCMD_MKENT(show, 2, 1, do_profile_show));
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show and reset hot-path event counters
+ */
+
+#include <common.h>
+#include <command.h>
+#include <stat.h>
+
+static int do_stats_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	stat_show(argc > 1 ? argv[1] : NULL);
+
+	return 0;
+}
+
+static int do_stats_reset(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	stat_reset(argc > 1 ? argv[1] : NULL);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(stats,
+	"show [<subsys>]        - show non-zero counters, optionally for one subsystem\n"
+	"stats reset [<subsys>] - set counters back to zero");
+
+U_BOOT_CMD_WITH_SUBCMDS(stats, "Hot-path event counters", stats_help_text,
+	U_BOOT_SUBCMD_MKENT(show, 2, 1, do_stats_show),
+	U_BOOT_SUBCMD_MKENT(reset, 2, 1, do_stats_reset));
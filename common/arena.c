@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Arena allocator with checkpoints
+ */
+
+#include <common.h>
+#include <arena.h>
+#include <malloc.h>
+#include <linux/kernel.h>
+
+enum {
+	ARENA_ALIGN	= 16,
+};
+
+/**
+ * struct arena_block - header of a block of memory in an arena
+ *
+ * @prev: Previous block, or NULL if this is the first
+ * @end: End of the block
+ * @data: Memory handed out by arena_alloc()
+ */
+struct arena_block {
+	struct arena_block *prev;
+	char *end;
+	char data[] __aligned(ARENA_ALIGN);
+};
+
+void arena_init(struct arena *arena, ulong block_size)
+{
+	memset(arena, '\0', sizeof(*arena));
+	arena->block_size = block_size;
+}
+
+void *arena_alloc(struct arena *arena, ulong size)
+{
+	struct arena_block *block;
+	ulong len;
+	void *ptr;
+
+	size = ALIGN(size, ARENA_ALIGN);
+	if (!arena->block || arena->end - arena->ptr < size) {
+		len = max(size, arena->block_size);
+		block = malloc(sizeof(*block) + len);
+		if (!block)
+			return NULL;
+		block->prev = arena->block;
+		block->end = block->data + len;
+		arena->block = block;
+		arena->ptr = block->data;
+		arena->end = block->end;
+	}
+	ptr = arena->ptr;
+	arena->ptr += size;
+
+	return ptr;
+}
+
+void arena_mark(struct arena *arena, struct arena_mark *mark)
+{
+	mark->block = arena->block;
+	mark->ptr = arena->ptr;
+}
+
+void arena_release(struct arena *arena, const struct arena_mark *mark)
+{
+	while (arena->block != mark->block) {
+		struct arena_block *block = arena->block;
+
+		arena->block = block->prev;
+		free(block);
+	}
+	arena->ptr = mark->ptr;
+	arena->end = arena->block ? arena->block->end : NULL;
+}
+
+void arena_uninit(struct arena *arena)
+{
+	struct arena_mark start = { };
+
+	arena_release(arena, &start);
+}
@@ -18,6 +18,7 @@
 #include <malloc.h>
 #include <sort.h>
 #include <spl.h>
+#include <stat.h>
 #include <asm/global_data.h>
 #include <linux/compiler.h>
 #include <linux/libfdt.h>
@@ -46,6 +47,14 @@ enum {
 	BOOTSTAGE_VERSION	= 0,
 	BOOTSTAGE_MAGIC		= 0xb00757a3,
 	BOOTSTAGE_DIGITS	= 9,
+
+	/*
+	 * Process and track IDs used in the trace-event JSON output. The PID
+	 * matches TRACE_PID in proftool, so that the two files can be merged.
+	 */
+	BOOTSTAGE_JSON_PID	= 1,
+	BOOTSTAGE_JSON_TID_MARK	= 0,
+	BOOTSTAGE_JSON_TID_ACCUM = 1,
 };
 
 struct bootstage_hdr {
@@ -315,6 +324,9 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 			return -EINVAL;
 	}
 
+	if (CONFIG_IS_ENABLED(STATS) && stat_fdt_add(blob, bootstage))
+		return -EINVAL;
+
 	return 0;
 }
 
@@ -359,6 +371,119 @@ void bootstage_report(void)
 	}
 }
 
+/**
+ * struct json_buf - Output state for bootstage_export_json()
+ *
+ * @ptr: Next position to write to
+ * @end: End of the buffer
+ * @len: Number of bytes that the output needs, which may be larger than the
+ *	buffer
+ */
+struct json_buf {
+	char *ptr;
+	char *end;
+	int len;
+};
+
+static void json_printf(struct json_buf *jb, const char *fmt, ...)
+{
+	va_list args;
+	int space, ret;
+
+	space = jb->end - jb->ptr;
+	va_start(args, fmt);
+	ret = vsnprintf(jb->ptr, space, fmt, args);
+	va_end(args);
+	jb->len += ret;
+	jb->ptr += min(ret, space ? space - 1 : 0);
+}
+
+/* Write a quoted JSON string, escaping characters that need it */
+static void json_put_str(struct json_buf *jb, const char *str)
+{
+	json_printf(jb, "\"");
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\')
+			json_printf(jb, "\\%c", *str);
+		else if ((unsigned char)*str < ' ')
+			json_printf(jb, "\\u%04x", *str);
+		else
+			json_printf(jb, "%c", *str);
+	}
+	json_printf(jb, "\"");
+}
+
+static void json_thread_name(struct json_buf *jb, int tid, const char *name)
+{
+	json_printf(jb, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+		    BOOTSTAGE_JSON_PID, tid);
+	json_put_str(jb, name);
+	json_printf(jb, "}},\n");
+}
+
+int bootstage_export_json(char *buf, int size)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec;
+	struct json_buf jb;
+	ulong prev = 0;
+	char name[20];
+	int i;
+
+	jb.ptr = buf;
+	jb.end = buf + size;
+	jb.len = 0;
+	if (size)
+		*buf = '\0';
+
+	json_printf(&jb, "{\"traceEvents\":[\n");
+	json_printf(&jb, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"U-Boot\"}},\n",
+		    BOOTSTAGE_JSON_PID);
+	json_thread_name(&jb, BOOTSTAGE_JSON_TID_MARK, "boot stages");
+	json_thread_name(&jb, BOOTSTAGE_JSON_TID_ACCUM, "accumulated");
+
+	qsort(data->record, data->rec_count, sizeof(*rec), h_compare_record);
+
+	/*
+	 * A mark is a point in time, so show each one as a span starting at
+	 * the previous mark. That gives a contiguous timeline in which each
+	 * span is named after the stage it finishes with.
+	 */
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (rec->start_us)
+			continue;
+		if (rec->id != BOOTSTAGE_ID_AWAKE && !rec->time_us)
+			continue;
+		json_printf(&jb, "{\"name\":");
+		json_put_str(&jb, get_record_name(name, sizeof(name), rec));
+		json_printf(&jb, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":%d,\"tid\":%d},\n",
+			    rec->flags & BOOTSTAGEF_ERROR ? "error" : "mark",
+			    prev, rec->time_us - prev, BOOTSTAGE_JSON_PID,
+			    BOOTSTAGE_JSON_TID_MARK);
+		prev = rec->time_us;
+	}
+
+	/*
+	 * Accumulated records only hold a total and the start of the most
+	 * recent interval, so they are shown as that last interval with the
+	 * total attached.
+	 */
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (!rec->start_us)
+			continue;
+		json_printf(&jb, "{\"name\":");
+		json_put_str(&jb, get_record_name(name, sizeof(name), rec));
+		json_printf(&jb, ",\"cat\":\"accum\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%u,\"pid\":%d,\"tid\":%d,\"args\":{\"total_us\":%lu}},\n",
+			    rec->start_us, BOOTSTAGE_JSON_PID,
+			    BOOTSTAGE_JSON_TID_ACCUM, rec->time_us);
+	}
+
+	/* Chrome does not accept a trailing comma, so close with an empty event */
+	json_printf(&jb, "{}],\"displayTimeUnit\":\"ms\"}\n");
+
+	return jb.len;
+}
+
 /**
  * Append data to a memory buffer
  *
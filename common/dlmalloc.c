@@ -623,6 +623,196 @@ void mem_malloc_init(ulong start, ulong size)
 #endif
 }
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+/*
+ * Per-CPU cache of small free chunks
+ *
+ * A freed chunk of up to CONFIG_SYS_MALLOC_CACHE_MAX bytes is pushed onto a
+ * per-CPU list for its exact size instead of going back to the bins, and the
+ * next malloc() of that size pops it again. Cached chunks still look in use
+ * to the rest of dlmalloc, so they are never merged or split.
+ *
+ * Secondary CPUs never touch the bins: they only allocate from and free to
+ * their own lists, so they need no lock. See malloc_cache_fill(). A chunk
+ * which is too large to cache is queued on the CPU's @pending list instead,
+ * and goes back to the bins when the boot CPU calls malloc_cache_flush().
+ */
+#define MALLOC_CACHE_CLASSES \
+	((CONFIG_SYS_MALLOC_CACHE_MAX - MINSIZE) / MALLOC_ALIGNMENT + 1)
+
+/**
+ * struct malloc_cache - cached chunks for one CPU
+ *
+ * @list: Free chunks for each size class, linked through their first word
+ * @count: Number of chunks on each list
+ * @pending: Chunks freed by a secondary CPU which are too large to cache,
+ *	waiting for malloc_cache_flush() to put them back in the bins
+ * @pending_bytes: Total size of the chunks on @pending
+ * @hits: Number of allocations satisfied from the cache
+ * @misses: Number of cacheable allocations which went to the bins
+ */
+struct malloc_cache {
+	void *list[MALLOC_CACHE_CLASSES];
+	uint count[MALLOC_CACHE_CLASSES];
+	void *pending;
+	ulong pending_bytes;
+	ulong hits;
+	ulong misses;
+};
+
+static void free_chunk(Void_t *mem);
+
+static struct malloc_cache malloc_caches[CONFIG_SYS_MALLOC_CACHE_CPUS];
+
+__weak uint malloc_cache_cpu(void)
+{
+	return 0;
+}
+
+__weak bool malloc_cache_secondary(void)
+{
+	return false;
+}
+
+static struct malloc_cache *malloc_cache_get(uint cpu)
+{
+	return cpu < CONFIG_SYS_MALLOC_CACHE_CPUS ? &malloc_caches[cpu] : NULL;
+}
+
+/* Take a chunk of padded size @nb from the cache, or return NULL */
+static Void_t *malloc_cache_take(INTERNAL_SIZE_T nb)
+{
+	struct malloc_cache *cache = malloc_cache_get(malloc_cache_cpu());
+	uint idx = (nb - MINSIZE) / MALLOC_ALIGNMENT;
+	void **mem;
+
+	if (!cache || nb > CONFIG_SYS_MALLOC_CACHE_MAX)
+		return NULL;
+	mem = cache->list[idx];
+	if (!mem) {
+		cache->misses++;
+		return NULL;
+	}
+	cache->list[idx] = *mem;
+	cache->count[idx]--;
+	cache->hits++;
+
+	return mem;
+}
+
+static void malloc_cache_push(struct malloc_cache *cache, Void_t *mem)
+{
+	uint idx = (chunksize(mem2chunk(mem)) - MINSIZE) / MALLOC_ALIGNMENT;
+
+	*(void **)mem = cache->list[idx];
+	cache->list[idx] = mem;
+	cache->count[idx]++;
+}
+
+/*
+ * Put a chunk in the cache. Returns false if it should go back to the bins
+ * instead. On a secondary CPU this always returns true, since the bins must
+ * not be touched there: a chunk which is too large to cache is queued for the
+ * boot CPU. Only a CPU without a cache has nowhere to put it, so leaks it.
+ */
+static bool malloc_cache_put(Void_t *mem)
+{
+	bool secondary = malloc_cache_secondary();
+	struct malloc_cache *cache;
+	INTERNAL_SIZE_T sz;
+
+	cache = malloc_cache_get(malloc_cache_cpu());
+	sz = chunksize(mem2chunk(mem));
+	if (!cache)
+		return secondary;
+	if (sz > CONFIG_SYS_MALLOC_CACHE_MAX) {
+		if (!secondary)
+			return false;
+		*(void **)mem = cache->pending;
+		cache->pending = mem;
+		cache->pending_bytes += sz;
+		return true;
+	}
+	if (!secondary && cache->count[(sz - MINSIZE) / MALLOC_ALIGNMENT] >=
+	    CONFIG_SYS_MALLOC_CACHE_DEPTH)
+		return false;
+	malloc_cache_push(cache, mem);
+
+	return true;
+}
+
+int malloc_cache_fill(uint cpu, size_t bytes, uint count)
+{
+	struct malloc_cache *cache = malloc_cache_get(cpu);
+	uint i;
+
+	if (!cache || request2size(bytes) > CONFIG_SYS_MALLOC_CACHE_MAX)
+		return -EINVAL;
+	for (i = 0; i < count; i++) {
+		Void_t *mem = mALLOc(bytes);
+
+		if (!mem)
+			return -ENOMEM;
+		malloc_cache_push(cache, mem);
+	}
+
+	return 0;
+}
+
+/* Count the bytes held in all the caches, and optionally the chunks */
+static ulong malloc_cache_bytes(ulong *chunksp)
+{
+	ulong bytes = 0, chunks = 0;
+	uint cpu, idx;
+
+	for (cpu = 0; cpu < CONFIG_SYS_MALLOC_CACHE_CPUS; cpu++) {
+		struct malloc_cache *cache = &malloc_caches[cpu];
+		void **mem;
+
+		for (mem = cache->pending; mem; mem = *mem)
+			chunks++;
+		for (idx = 0; idx < MALLOC_CACHE_CLASSES; idx++) {
+			bytes += cache->count[idx] *
+				(MINSIZE + idx * MALLOC_ALIGNMENT);
+			chunks += cache->count[idx];
+		}
+		bytes += cache->pending_bytes;
+	}
+	if (chunksp)
+		*chunksp = chunks;
+
+	return bytes;
+}
+
+/* Put a list of chunks back in the bins */
+static void malloc_cache_drain(void **mem)
+{
+	while (mem) {
+		void **next = *mem;
+
+		free_chunk(mem);
+		mem = next;
+	}
+}
+
+void malloc_cache_flush(uint cpu)
+{
+	struct malloc_cache *cache = malloc_cache_get(cpu);
+	uint idx;
+
+	if (!cache)
+		return;
+	for (idx = 0; idx < MALLOC_CACHE_CLASSES; idx++) {
+		malloc_cache_drain(cache->list[idx]);
+		cache->list[idx] = NULL;
+		cache->count[idx] = 0;
+	}
+	malloc_cache_drain(cache->pending);
+	cache->pending = NULL;
+	cache->pending_bytes = 0;
+}
+#endif /* SYS_MALLOC_CACHE */
+
 /* field-extraction macros */
 
 #define first(b) ((b)->fd)
@@ -1311,6 +1501,15 @@ Void_t* mALLOc(bytes) size_t bytes;
 
   nb = request2size(bytes);  /* padded request size; */
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+  {
+    Void_t *mem = malloc_cache_take(nb);
+
+    if (mem || malloc_cache_secondary())
+      return mem;
+  }
+#endif
+
   /* Check for exact match in a bin */
 
   if (is_small_request(nb))  /* Faster version for small requests */
@@ -1561,17 +1760,6 @@ void fREe(Void_t* mem)
 void fREe(mem) Void_t* mem;
 #endif
 {
-  mchunkptr p;         /* chunk corresponding to mem */
-  INTERNAL_SIZE_T hd;  /* its head field */
-  INTERNAL_SIZE_T sz;  /* its size */
-  int       idx;       /* its bin index */
-  mchunkptr next;      /* next contiguous chunk */
-  INTERNAL_SIZE_T nextsz; /* its size */
-  INTERNAL_SIZE_T prevsz; /* size of previous contiguous chunk */
-  mchunkptr bck;       /* misc temp for linking */
-  mchunkptr fwd;       /* misc temp for linking */
-  int       islr;      /* track whether merging with last_remainder */
-
 #if CONFIG_IS_ENABLED(SYS_MALLOC_F)
 	/* free() is a no-op - all the memory will be freed on relocation */
 	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
@@ -1583,6 +1771,28 @@ void fREe(mem) Void_t* mem;
   if (mem == NULL)                              /* free(0) has no effect */
     return;
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+  if (malloc_cache_put(mem))
+    return;
+#endif
+
+  free_chunk(mem);
+}
+
+/* Put a chunk back in the bins, bypassing the cache */
+static void free_chunk(Void_t *mem)
+{
+  mchunkptr p;         /* chunk corresponding to mem */
+  INTERNAL_SIZE_T hd;  /* its head field */
+  INTERNAL_SIZE_T sz;  /* its size */
+  int       idx;       /* its bin index */
+  mchunkptr next;      /* next contiguous chunk */
+  INTERNAL_SIZE_T nextsz; /* its size */
+  INTERNAL_SIZE_T prevsz; /* size of previous contiguous chunk */
+  mchunkptr bck;       /* misc temp for linking */
+  mchunkptr fwd;       /* misc temp for linking */
+  int       islr;      /* track whether merging with last_remainder */
+
   p = mem2chunk(mem);
   hd = p->size;
 
@@ -1735,6 +1945,12 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
   /* realloc of null is supposed to be same as malloc */
   if (oldmem == NULL) return mALLOc(bytes);
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+  /* secondary CPUs can only use their cache, which cannot resize chunks */
+  if (malloc_cache_secondary())
+    return NULL;
+#endif
+
 #if CONFIG_IS_ENABLED(SYS_MALLOC_F)
 	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
 		/* This is harder to support and should not be needed */
@@ -1967,6 +2183,11 @@ Void_t* mEMALIGn(alignment, bytes) size_t alignment; size_t bytes;
 
   if (alignment <= MALLOC_ALIGNMENT) return mALLOc(bytes);
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+  if (malloc_cache_secondary())
+    return NULL;
+#endif
+
   /* Otherwise, ensure that it is at least a minimum chunk size */
 
   if (alignment <  MINSIZE) alignment = MINSIZE;
@@ -2355,6 +2576,11 @@ static void malloc_update_mallinfo(void)
     }
   }
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+  /* cached chunks are free as far as callers are concerned */
+  avail += malloc_cache_bytes(NULL);
+#endif
+
   current_mallinfo.ordblks = navail;
   current_mallinfo.uordblks = sbrked_mem - avail;
   current_mallinfo.fordblks = avail;
@@ -2453,6 +2679,46 @@ int mALLOPt(param_number, value) int param_number; int value;
   }
 }
 
+void malloc_get_info(struct malloc_info *info)
+{
+  mchunkptr p;
+  mbinptr b;
+  int i;
+
+  memset(info, '\0', sizeof(*info));
+  if (!mem_malloc_start && !mem_malloc_end)
+    return;
+
+  info->total = mem_malloc_end - mem_malloc_start;
+  info->peak = max_sbrked_mem;
+
+  /* the top chunk can grow into the part of the heap not yet sbrk()ed */
+  info->largest_free = chunksize(top) + mem_malloc_end - mem_malloc_brk;
+  info->free = info->largest_free;
+  for (i = 1; i < NAV; ++i)
+  {
+    b = bin_at(i);
+    for (p = last(b); p != b; p = p->bk)
+    {
+      info->free += chunksize(p);
+      info->free_chunks++;
+      info->largest_free = max_t(ulong, info->largest_free, chunksize(p));
+    }
+  }
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_CACHE)
+  for (i = 0; i < CONFIG_SYS_MALLOC_CACHE_CPUS; i++)
+  {
+    struct malloc_cache *cache = &malloc_caches[i];
+
+    info->cache_hits += cache->hits;
+    info->cache_misses += cache->misses;
+  }
+  info->cached = malloc_cache_bytes(&info->cached_chunks);
+#endif
+  info->in_use = info->total - info->free - info->cached;
+}
+
 int initf_malloc(void)
 {
 #if CONFIG_IS_ENABLED(SYS_MALLOC_F)
@@ -6,6 +6,8 @@
  */
 
 #include <common.h>
+#include <hexdump.h>
+#include <kallsyms.h>
 
 /* We need the weak marking as this symbol is provided specially */
 extern const char system_map[] __attribute__((weak));
@@ -21,20 +23,47 @@ extern const char system_map[] __attribute__((weak));
  *		sym = "_spi_cs_deactivate";
  */
 const char *symbol_lookup(unsigned long addr, unsigned long *caddr)
+{
+	unsigned long naddr;
+
+	return symbol_lookup_range(addr, caddr, &naddr);
+}
+
+/*
+ * Addresses in the map have a fixed width and are immediately followed by the
+ * name, so parse exactly that many digits; otherwise a name which starts with
+ * a hex digit, such as 'blk_read', would be taken as part of the address.
+ */
+static unsigned long symbol_addr(const char **symp)
+{
+	const char *sym = *symp;
+	unsigned long addr = 0;
+	int i;
+
+	for (i = 0; i < sizeof(addr) * 2 && *sym; i++, sym++)
+		addr = addr << 4 | hex_to_bin(*sym);
+	*symp = sym;
+
+	return addr;
+}
+
+const char *symbol_lookup_range(unsigned long addr, unsigned long *caddr,
+				unsigned long *naddr)
 {
 	const char *sym, *csym;
-	char *esym;
 	unsigned long sym_addr;
 
 	sym = system_map;
 	csym = NULL;
 	*caddr = 0;
+	*naddr = ~0UL;
 
 	while (*sym) {
-		sym_addr = hextoul(sym, &esym);
-		sym = esym;
-		if (sym_addr > addr)
+		sym_addr = symbol_addr(&sym);
+		if (sym_addr > addr) {
+			*naddr = sym_addr;
 			break;
+		}
 		*caddr = sym_addr;
 		csym = sym;
 		sym += strlen(sym) + 1;
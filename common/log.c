@@ -160,9 +160,12 @@ static bool log_passes_filters(struct log_device *ldev, struct log_rec *rec)
 	if (rec->flags & LOGRECF_FORCE_DEBUG)
 		return true;
 
-	/* If there are no filters, filter on the default log level */
+	/*
+	 * If there are no filters, filter on the driver's level, or the
+	 * default log level
+	 */
 	if (list_empty(&ldev->filter_head)) {
-		if (rec->level > gd->default_log_level)
+		if (rec->level > (ldev->drv->level ?: gd->default_log_level))
 			return false;
 		return true;
 	}
@@ -221,10 +224,22 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 	list_for_each_entry(ldev, &gd->log_head, sibling_node) {
 		if ((ldev->flags & LOGDF_ENABLE) &&
 		    log_passes_filters(ldev, rec)) {
+			if (ldev->drv->emit_fmt) {
+				va_list cargs;
+
+				va_copy(cargs, args);
+				ldev->drv->emit_fmt(ldev, rec, fmt, cargs);
+				va_end(cargs);
+				continue;
+			}
 			if (!rec->msg) {
+				va_list cargs;
 				int len;
 
-				len = vsnprintf(buf, sizeof(buf), fmt, args);
+				/* leave @args intact for any emit_fmt() */
+				va_copy(cargs, args);
+				len = vsnprintf(buf, sizeof(buf), fmt, cargs);
+				va_end(cargs);
 				rec->msg = buf;
 				gd->log_cont = len && buf[len - 1] != '\n';
 			}
@@ -262,6 +277,20 @@ int _log(enum log_category_t cat, enum log_level_t level, const char *file,
 	rec.func = func;
 	rec.msg = NULL;
 
+#if CONFIG_IS_ENABLED(LOG_RING)
+	/* secondary CPUs must not use the console, so only use the ring */
+	if (log_ring_secondary()) {
+		if (rec.level > CONFIG_LOG_RING_LEVEL &&
+		    !(rec.flags & LOGRECF_FORCE_DEBUG))
+			return 0;
+		va_start(args, fmt);
+		log_ring_add(&rec, fmt, args);
+		va_end(args);
+
+		return 0;
+	}
+#endif
+
 	if (!(gd->flags & GD_FLG_LOG_READY)) {
 		gd->log_drop_count++;
 
@@ -0,0 +1,561 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Log driver which keeps binary records in a ring buffer per CPU
+ *
+ * Each record holds the format string pointer and a copy of the raw arguments,
+ * so nothing is formatted until the log is dumped. Every CPU writes only to
+ * its own ring, so no locking is needed and secondary CPUs can log without
+ * touching the console.
+ */
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <linux/ctype.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	LOG_RING_ALIGN		= 8,
+	LOG_RING_REC_MAX	= 512,	/* largest record, including header */
+	LOG_RING_STR_MAX	= 64,	/* longest %s argument kept */
+	LOG_RING_SPEC_MAX	= 32,	/* longest conversion specification */
+
+	LOG_RING_LEVEL_PAD	= 0xff,	/* record is padding up to the end */
+
+	LOG_RING_RECF_TEXT	= BIT(0),	/* args hold the formatted text */
+};
+
+/**
+ * struct log_ring_rec - header of a record in the ring
+ *
+ * @size: Size of the record in bytes, including this header
+ * @cat: Category (enum log_category_t)
+ * @line: Source line number
+ * @level: Log level (enum log_level_t), or LOG_RING_LEVEL_PAD
+ * @flags: Record flags (LOG_RING_RECF_...)
+ * @fmt: printf() format string, or NULL if LOG_RING_RECF_TEXT is set
+ * @file: Source file name
+ * @func: Function name
+ * @args: Packed arguments, in the order used by @fmt
+ */
+struct log_ring_rec {
+	u16 size;
+	u16 cat;
+	u16 line;
+	u8 level;
+	u8 flags;
+	const char *fmt;
+	const char *file;
+	const char *func;
+	u64 args[];
+};
+
+/**
+ * struct log_ring - ring buffer for one CPU
+ *
+ * @head and @tail count bytes written since the start, so the ring holds the
+ * records from @tail up to @head. Only the owning CPU updates them. Space is
+ * freed by publishing a new @tail before it is overwritten, and a record is
+ * added by publishing a new @head after it is written, so that a reader on
+ * another CPU can tell whether what it read is still valid.
+ *
+ * @buf: Ring buffer, CONFIG_LOG_RING_SIZE bytes
+ * @head: Position of the next record
+ * @tail: Position of the oldest record
+ * @lost: Number of records overwritten or not recorded
+ */
+struct log_ring {
+	char *buf;
+	ulong head;
+	ulong tail;
+	ulong lost;
+};
+
+/**
+ * struct log_ring_spec - a conversion specification within a format string
+ *
+ * @start: Start of the specification (the '%')
+ * @len: Length of the specification
+ * @nstar: Number of '*' width/precision arguments it takes
+ * @length: Length modifier: 0 for int, 'l' for long, 'L' for long long
+ * @conv: Conversion character, e.g. 'd', 's'
+ * @safe: true if the arguments can be copied and formatted later
+ */
+struct log_ring_spec {
+	const char *start;
+	int len;
+	int nstar;
+	char length;
+	char conv;
+	bool safe;
+};
+
+static struct log_ring log_rings[CONFIG_LOG_RING_CPUS];
+
+__weak uint log_ring_cpu(void)
+{
+	return 0;
+}
+
+__weak bool log_ring_secondary(void)
+{
+	return false;
+}
+
+/**
+ * log_ring_next_spec() - Find the next conversion specification in a format
+ *
+ * @fmt: Format string to search
+ * @spec: Returns information about the specification found
+ * Return: pointer just past the specification, or NULL if there are no more
+ */
+static const char *log_ring_next_spec(const char *fmt, struct log_ring_spec *spec)
+{
+	const char *p = strchr(fmt, '%');
+
+	if (!p)
+		return NULL;
+	spec->start = p++;
+	spec->nstar = 0;
+	spec->length = 0;
+	spec->safe = true;
+
+	while (*p && strchr("-+ #0", *p))
+		p++;
+	for (; *p == '*' || *p == '.' || isdigit(*p); p++) {
+		if (*p == '*')
+			spec->nstar++;
+	}
+	for (; *p && strchr("hlLqjzZt", *p); p++) {
+		if (*p == 'L' || *p == 'q' || *p == 'j' ||
+		    (*p == 'l' && spec->length == 'l'))
+			spec->length = 'L';
+		else if (*p != 'h')
+			spec->length = 'l';
+	}
+	spec->conv = *p;
+	if (*p)
+		p++;
+
+	switch (spec->conv) {
+	case '%':
+	case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+	case 's':
+		break;
+	case 'p':
+		/* extensions such as %pU read the data they point to */
+		if (isalnum(*p))
+			spec->safe = false;
+		break;
+	default:
+		spec->safe = false;
+		break;
+	}
+	spec->len = p - spec->start;
+	if (spec->len >= LOG_RING_SPEC_MAX)
+		spec->safe = false;
+
+	return p;
+}
+
+/* Check that every argument of a format can be copied into the record */
+static bool log_ring_fmt_safe(const char *fmt)
+{
+	struct log_ring_spec spec;
+
+	while ((fmt = log_ring_next_spec(fmt, &spec))) {
+		if (!spec.safe)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * log_ring_pack() - Copy the arguments of a format into a record
+ *
+ * Numbers and pointers take one u64 each. Strings are copied, truncated to
+ * LOG_RING_STR_MAX, and padded to a multiple of 8 bytes.
+ *
+ * @fmt: Format string, which must pass log_ring_fmt_safe()
+ * @args: Arguments for @fmt
+ * @out: Buffer to write to
+ * @size: Size of buffer in bytes
+ * Return: number of bytes used, or -ENOSPC if the buffer is too small
+ */
+static int log_ring_pack(const char *fmt, va_list args, u64 *out, int size)
+{
+	struct log_ring_spec spec;
+	u64 *ptr = out, *end = out + size / sizeof(u64);
+	int i;
+
+	while ((fmt = log_ring_next_spec(fmt, &spec))) {
+		if (spec.conv == '%')
+			continue;
+		if (ptr + spec.nstar + 1 > end)
+			return -ENOSPC;
+		for (i = 0; i < spec.nstar; i++)
+			*ptr++ = va_arg(args, int);
+		if (spec.conv == 's') {
+			const char *str = va_arg(args, const char *);
+			int len;
+
+			if (!str)
+				str = "(null)";
+			len = strnlen(str, LOG_RING_STR_MAX - 1);
+			if ((char *)ptr + len + 1 > (char *)end)
+				return -ENOSPC;
+			memcpy(ptr, str, len);
+			((char *)ptr)[len] = '\0';
+			ptr += DIV_ROUND_UP(len + 1, sizeof(u64));
+		} else if (spec.conv == 'p') {
+			*ptr++ = (ulong)va_arg(args, void *);
+		} else if (spec.length == 'L') {
+			*ptr++ = va_arg(args, long long);
+		} else if (spec.length == 'l') {
+			*ptr++ = va_arg(args, long);
+		} else {
+			*ptr++ = va_arg(args, int);
+		}
+	}
+
+	return (ptr - out) * sizeof(u64);
+}
+
+static int log_ring_snprintf_arg(char *buf, int size, const char *spec,
+				 const int *star, int nstar,
+				 const struct log_ring_spec *info,
+				 const u64 *arg)
+{
+#define LOG_RING_FMT(_val)						\
+	(nstar == 0 ? snprintf(buf, size, spec, _val) :		\
+	 nstar == 1 ? snprintf(buf, size, spec, star[0], _val) :	\
+	 snprintf(buf, size, spec, star[0], star[1], _val))
+
+	if (info->conv == 's')
+		return LOG_RING_FMT((const char *)arg);
+	else if (info->conv == 'p')
+		return LOG_RING_FMT((void *)(ulong)*arg);
+	else if (info->length == 'L')
+		return LOG_RING_FMT((long long)*arg);
+	else if (info->length == 'l')
+		return LOG_RING_FMT((long)*arg);
+
+	return LOG_RING_FMT((int)*arg);
+#undef LOG_RING_FMT
+}
+
+/**
+ * log_ring_format() - Format the message in a record
+ *
+ * @rec: Record to format
+ * @buf: Buffer to write to
+ * @size: Size of buffer, which must be at least 1
+ */
+static void log_ring_format(const struct log_ring_rec *rec, char *buf,
+			    int size)
+{
+	const u64 *arg = rec->args;
+	const char *fmt = rec->fmt;
+	struct log_ring_spec spec;
+	const char *next;
+	char *end = buf + size - 1;
+
+	if (rec->flags & LOG_RING_RECF_TEXT) {
+		strlcpy(buf, (const char *)rec->args, size);
+		return;
+	}
+	while (buf < end && (next = log_ring_next_spec(fmt, &spec))) {
+		char specstr[LOG_RING_SPEC_MAX];
+		int star[2] = {0, 0};
+		int len, i;
+
+		len = min_t(int, spec.start - fmt, end - buf);
+		memcpy(buf, fmt, len);
+		buf += len;
+		fmt = next;
+		if (spec.conv == '%') {
+			if (buf < end)
+				*buf++ = '%';
+			continue;
+		}
+
+		for (i = 0; i < spec.nstar; i++, arg++) {
+			if (i < ARRAY_SIZE(star))
+				star[i] = *arg;
+		}
+		strlcpy(specstr, spec.start, spec.len + 1);
+		len = log_ring_snprintf_arg(buf, end - buf + 1, specstr, star,
+					    min(spec.nstar, 2), &spec, arg);
+		buf += min_t(int, len, end - buf);
+		if (spec.conv == 's')
+			arg += DIV_ROUND_UP(strlen((char *)arg) + 1, sizeof(u64));
+		else
+			arg++;
+	}
+	strlcpy(buf, fmt, end - buf + 1);
+}
+
+/* Allocate the rings; this is done by the boot CPU on its first record */
+static int log_ring_alloc(void)
+{
+	int i;
+
+	BUILD_BUG_ON(CONFIG_LOG_RING_SIZE % LOG_RING_ALIGN);
+
+	if (log_rings[0].buf)
+		return 0;
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return -EAGAIN;
+	for (i = 0; i < CONFIG_LOG_RING_CPUS; i++) {
+		log_rings[i].buf = malloc(CONFIG_LOG_RING_SIZE);
+		if (!log_rings[i].buf)
+			return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* Drop the oldest records until there are @size free bytes */
+static void log_ring_make_space(struct log_ring *ring, ulong size)
+{
+	ulong tail = ring->tail;
+
+	while (CONFIG_LOG_RING_SIZE - (ring->head - tail) < size) {
+		struct log_ring_rec *old;
+
+		old = (void *)ring->buf + tail % CONFIG_LOG_RING_SIZE;
+		if (old->level != LOG_RING_LEVEL_PAD)
+			ring->lost++;
+		tail += old->size;
+	}
+	if (tail == ring->tail)
+		return;
+
+	/* readers must see the new tail before the space is reused */
+	__atomic_store_n(&ring->tail, tail, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+int log_ring_add(struct log_rec *rec, const char *fmt, va_list args)
+{
+	u64 data[LOG_RING_REC_MAX / sizeof(u64)];
+	struct log_ring_rec *out = (void *)data;
+	struct log_ring *ring;
+	ulong pos, room;
+	uint cpu;
+	int len;
+
+	cpu = log_ring_cpu();
+	if (cpu >= CONFIG_LOG_RING_CPUS)
+		return -ENOENT;
+	ring = &log_rings[cpu];
+	if (!ring->buf && (log_ring_secondary() || log_ring_alloc())) {
+		ring->lost++;
+		return -EAGAIN;
+	}
+
+	/* build the record on the stack, then copy it in */
+	out->cat = rec->cat;
+	out->line = rec->line;
+	out->level = rec->level;
+	out->flags = 0;
+	out->fmt = fmt;
+	out->file = rec->file;
+	out->func = rec->func;
+	len = -ENOSPC;
+	if (log_ring_fmt_safe(fmt)) {
+		va_list cargs;
+
+		va_copy(cargs, args);
+		len = log_ring_pack(fmt, cargs, out->args,
+				    sizeof(data) - sizeof(*out));
+		va_end(cargs);
+	}
+	if (len < 0) {
+		/* format now if the arguments cannot be kept */
+		len = vsnprintf((char *)out->args, sizeof(data) - sizeof(*out),
+				fmt, args);
+		len = min_t(int, len + 1, sizeof(data) - sizeof(*out));
+		out->flags = LOG_RING_RECF_TEXT;
+		out->fmt = NULL;
+	}
+	out->size = ALIGN(sizeof(*out) + len, LOG_RING_ALIGN);
+
+	pos = ring->head % CONFIG_LOG_RING_SIZE;
+	room = CONFIG_LOG_RING_SIZE - pos;
+	if (room < out->size) {
+		struct log_ring_rec *pad = (void *)ring->buf + pos;
+
+		log_ring_make_space(ring, room);
+		pad->size = room;
+		pad->level = LOG_RING_LEVEL_PAD;
+		__atomic_store_n(&ring->head, ring->head + room,
+				 __ATOMIC_RELEASE);
+		pos = 0;
+	}
+	log_ring_make_space(ring, out->size);
+	memcpy(ring->buf + pos, out, out->size);
+	__atomic_store_n(&ring->head, ring->head + out->size, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/**
+ * log_ring_read() - Copy a record out of a ring
+ *
+ * The owning CPU may be adding records while this runs, so the record is
+ * checked against @head and copied, and then @tail is read again to make sure
+ * that it was not overwritten in the meantime.
+ *
+ * @ring: Ring to read from
+ * @pos: Position of the record
+ * @head: Head of the ring, read before starting
+ * @data: Returns a copy of the record
+ * Return: size of the record, or 0 if it is not valid (any more)
+ */
+static uint log_ring_read(struct log_ring *ring, ulong pos, ulong head,
+			  u64 data[LOG_RING_REC_MAX / sizeof(u64)])
+{
+	const struct log_ring_rec *rec, *copy = (void *)data;
+	uint size, offset;
+
+	offset = pos % CONFIG_LOG_RING_SIZE;
+	rec = (void *)ring->buf + offset;
+	size = READ_ONCE(rec->size);
+	if (size < LOG_RING_ALIGN || size % LOG_RING_ALIGN ||
+	    size > LOG_RING_REC_MAX || size > head - pos ||
+	    size > CONFIG_LOG_RING_SIZE - offset)
+		return 0;
+	memcpy(data, rec, size);
+
+	/* the copy is good if the tail has not passed it in the meantime */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if ((long)(__atomic_load_n(&ring->tail, __ATOMIC_RELAXED) - pos) > 0)
+		return 0;
+	if (copy->size != size ||
+	    (copy->level != LOG_RING_LEVEL_PAD && size < sizeof(*rec)))
+		return 0;
+
+	return size;
+}
+
+/**
+ * log_ring_walk() - Format every record in the rings
+ *
+ * The records present when the walk starts are shown. Records which the
+ * owning CPU overwrites during the walk are skipped.
+ *
+ * @func: Function to call with each line of output
+ * @priv: Private data for @func
+ */
+static void log_ring_walk(void (*func)(const char *line, void *priv),
+			  void *priv)
+{
+	u64 data[LOG_RING_REC_MAX / sizeof(u64)];
+	const struct log_ring_rec *rec = (void *)data;
+	char line[CONFIG_SYS_CBSIZE];
+	int cpu;
+
+	for (cpu = 0; cpu < CONFIG_LOG_RING_CPUS; cpu++) {
+		struct log_ring *ring = &log_rings[cpu];
+		ulong pos, head;
+
+		if (!ring->buf)
+			continue;
+		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		if (ring->lost) {
+			snprintf(line, sizeof(line), "cpu%d: %lu records lost\n",
+				 cpu, ring->lost);
+			func(line, priv);
+		}
+		pos = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+		while ((long)(head - pos) > 0) {
+			uint size;
+			int len;
+
+			size = log_ring_read(ring, pos, head, data);
+			if (!size) {
+				/* overwritten; carry on from the oldest record */
+				ulong tail;
+
+				tail = __atomic_load_n(&ring->tail,
+						       __ATOMIC_ACQUIRE);
+				if ((long)(tail - pos) <= 0)
+					break;
+				pos = tail;
+				continue;
+			}
+			pos += size;
+			if (rec->level == LOG_RING_LEVEL_PAD)
+				continue;
+			len = snprintf(line, sizeof(line), "cpu%d: %s.%s %s() ",
+				       cpu, log_get_level_name(rec->level),
+				       log_get_cat_name(rec->cat), rec->func);
+			len = min_t(int, len, sizeof(line) - 2);
+			log_ring_format(rec, line + len, sizeof(line) - len - 1);
+			len = strlen(line);
+			if (!len || line[len - 1] != '\n')
+				strcpy(line + len, "\n");
+			func(line, priv);
+		}
+	}
+}
+
+static void log_ring_puts(const char *line, void *priv)
+{
+	puts(line);
+}
+
+void log_ring_show(void)
+{
+	log_ring_walk(log_ring_puts, NULL);
+}
+
+struct log_ring_export {
+	char *ptr;
+	char *end;
+	int len;
+};
+
+static void log_ring_copy(const char *line, void *priv)
+{
+	struct log_ring_export *exp = priv;
+	int len = strlen(line);
+
+	if (exp->ptr + len < exp->end) {
+		memcpy(exp->ptr, line, len + 1);
+		exp->ptr += len;
+	}
+	exp->len += len;
+}
+
+int log_ring_export(char *buf, int size)
+{
+	struct log_ring_export exp = {
+		.ptr = buf,
+		.end = buf + size,
+	};
+
+	if (size)
+		*buf = '\0';
+	log_ring_walk(log_ring_copy, &exp);
+
+	return exp.len;
+}
+
+static int log_ring_emit_fmt(struct log_device *ldev, struct log_rec *rec,
+			     const char *fmt, va_list args)
+{
+	return log_ring_add(rec, fmt, args);
+}
+
+LOG_DRIVER(ring) = {
+	.name		= "ring",
+	.emit_fmt	= log_ring_emit_fmt,
+	.flags		= LOGDF_ENABLE,
+	.level		= CONFIG_LOG_RING_LEVEL,
+};
@@ -5,4 +5,7 @@
  * Licensed under the GPL-2 or later.
  */
 
-const char const system_map[] = SYSTEM_MAP;
+/* Each line of the generated header is "<address><name>\000" */
+const char system_map[] =
+#include <generated/system_map.h>
+	"";
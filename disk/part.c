@@ -284,6 +284,7 @@ void part_init(struct blk_desc *desc)
 	struct part_driver *entry;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	part_efi_cache_invalidate(desc);
 
 	desc->part_type = PART_TYPE_UNKNOWN;
 	for (entry = drv; entry != drv + n_ents; entry++) {
@@ -714,6 +715,15 @@ int part_get_info_by_name(struct blk_desc *desc, const char *name,
 		return -ENOSYS;
 	}
 
+	if (part_drv->find_name) {
+		i = part_drv->find_name(desc, name);
+		if (i < 0)
+			return i;
+		ret = part_drv->get_info(desc, i, info);
+
+		return ret ? ret : i;
+	}
+
 	for (i = 1; i < part_drv->max_entries; i++) {
 		ret = part_drv->get_info(desc, i, info);
 		if (ret != 0) {
@@ -29,6 +29,7 @@
 #include <dm/ofnode.h>
 #include <linux/compiler.h>
 #include <linux/ctype.h>
+#include <linux/log2.h>
 #include <linux/printk.h>
 #include <u-boot/crc.h>
 
@@ -63,10 +64,10 @@ static int is_pte_valid(gpt_entry * pte);
 static int find_valid_gpt(struct blk_desc *desc, gpt_header *gpt_head,
 			  gpt_entry **pgpt_pte);
 
-static char *print_efiname(gpt_entry *pte)
+static void efiname_to_str(gpt_entry *pte, char *name)
 {
-	static char name[PARTNAME_SZ + 1];
 	int i;
+
 	for (i = 0; i < PARTNAME_SZ; i++) {
 		u8 c;
 		c = pte->partition_name[i] & 0xff;
@@ -74,6 +75,13 @@ static char *print_efiname(gpt_entry *pte)
 		name[i] = c;
 	}
 	name[PARTNAME_SZ] = 0;
+}
+
+static char *print_efiname(gpt_entry *pte)
+{
+	static char name[PARTNAME_SZ + 1];
+
+	efiname_to_str(pte, name);
 	return name;
 }
 
@@ -191,6 +199,168 @@ static void prepare_backup_gpt_header(gpt_header *gpt_h)
 }
 
 #if CONFIG_IS_ENABLED(EFI_PARTITION)
+/**
+ * struct gpt_table - a validated GPT read from a block device
+ *
+ * With CONFIG_EFI_PARTITION_CACHE this is kept in the block device's
+ * descriptor until the GPT may have changed.
+ *
+ * @head: GPT header
+ * @pte: Partition table entries, @head.num_partition_entries of them
+ * @hwpart: Hardware partition the GPT was read from
+ * @name_idx: Hash table of partition names; each slot holds the entry index
+ *	plus one, or 0 if empty
+ * @name_mask: Number of slots in @name_idx minus one
+ */
+struct gpt_table {
+	gpt_header head;
+	gpt_entry *pte;
+	int hwpart;
+	u16 *name_idx;
+	uint name_mask;
+};
+
+/* Partition names as seen by callers are limited by struct disk_partition */
+static void gpt_entry_name(gpt_entry *pte, char *name)
+{
+	char full[PARTNAME_SZ + 1];
+
+	efiname_to_str(pte, full);
+	strlcpy(name, full, PART_NAME_LEN);
+}
+
+static uint gpt_name_hash(const char *name)
+{
+	uint hash = 2166136261U;
+
+	while (*name)
+		hash = (hash ^ (u8)*name++) * 16777619U;
+
+	return hash;
+}
+
+/**
+ * gpt_name_slot() - Find the slot for a name in the name index
+ *
+ * @gpt: GPT to search
+ * @name: Partition name
+ * Return: slot holding @name, or the empty slot where it would go
+ */
+static uint gpt_name_slot(struct gpt_table *gpt, const char *name)
+{
+	char found[PART_NAME_LEN];
+	uint slot;
+
+	for (slot = gpt_name_hash(name) & gpt->name_mask; gpt->name_idx[slot];
+	     slot = (slot + 1) & gpt->name_mask) {
+		gpt_entry_name(&gpt->pte[gpt->name_idx[slot] - 1], found);
+		if (!strcmp(found, name))
+			break;
+	}
+
+	return slot;
+}
+
+/* Index the names of the valid entries; the first of any duplicates wins */
+static int gpt_index_names(struct gpt_table *gpt)
+{
+	int count = le32_to_cpu(gpt->head.num_partition_entries);
+	char name[PART_NAME_LEN];
+	uint size, slot;
+	int i;
+
+	size = roundup_pow_of_two(max(count, 1) * 2);
+	gpt->name_idx = calloc(size, sizeof(*gpt->name_idx));
+	if (!gpt->name_idx)
+		return -ENOMEM;
+	gpt->name_mask = size - 1;
+
+	for (i = 0; i < count; i++) {
+		if (!is_pte_valid(&gpt->pte[i]))
+			continue;
+		gpt_entry_name(&gpt->pte[i], name);
+		slot = gpt_name_slot(gpt, name);
+		if (!gpt->name_idx[slot])
+			gpt->name_idx[slot] = i + 1;
+	}
+
+	return 0;
+}
+
+static void gpt_free(struct gpt_table *gpt)
+{
+	if (gpt) {
+		free(gpt->name_idx);
+		free(gpt->pte);
+		free(gpt);
+	}
+}
+
+/**
+ * gpt_get() - Get the validated GPT of a block device
+ *
+ * @desc: Block device descriptor
+ * Return: GPT, which must be released with gpt_put(), or NULL if there is no
+ *	valid GPT or out of memory
+ */
+static struct gpt_table *gpt_get(struct blk_desc *desc)
+{
+	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, desc->blksz);
+	struct gpt_table *gpt;
+
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+	gpt = desc->gpt_cache;
+	if (gpt && gpt->hwpart == desc->hwpart)
+		return gpt;
+	part_efi_cache_invalidate(desc);
+#endif
+	gpt = calloc(1, sizeof(*gpt));
+	if (!gpt)
+		return NULL;
+
+	/* This function validates AND fills in the GPT header and PTE */
+	if (find_valid_gpt(desc, gpt_head, &gpt->pte) != 1) {
+		free(gpt);
+		return NULL;
+	}
+	memcpy(&gpt->head, gpt_head, sizeof(gpt->head));
+	gpt->hwpart = desc->hwpart;
+	if (gpt_index_names(gpt)) {
+		gpt_free(gpt);
+		return NULL;
+	}
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+	desc->gpt_cache = gpt;
+#endif
+
+	return gpt;
+}
+
+static void gpt_put(struct gpt_table *gpt)
+{
+	if (!CONFIG_IS_ENABLED(EFI_PARTITION_CACHE))
+		gpt_free(gpt);
+}
+
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+void part_efi_cache_invalidate(struct blk_desc *desc)
+{
+	gpt_free(desc->gpt_cache);
+	desc->gpt_cache = NULL;
+}
+
+void part_efi_cache_write(struct blk_desc *desc, lbaint_t start,
+			  lbaint_t blkcnt)
+{
+	struct gpt_table *gpt = desc->gpt_cache;
+
+	/* the headers and entries all lie outside the usable area */
+	if (gpt && (start < le64_to_cpu(gpt->head.first_usable_lba) ||
+		    start + blkcnt > le64_to_cpu(gpt->head.last_usable_lba) + 1))
+		part_efi_cache_invalidate(desc);
+}
+#endif
+
 /*
  * Public Functions (include/part.h)
  */
@@ -201,32 +371,33 @@ static void prepare_backup_gpt_header(gpt_header *gpt_h)
  */
 int get_disk_guid(struct blk_desc *desc, char *guid)
 {
-	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, desc->blksz);
-	gpt_entry *gpt_pte = NULL;
+	struct gpt_table *gpt;
 	unsigned char *guid_bin;
 
-	/* This function validates AND fills in the GPT header and PTE */
-	if (find_valid_gpt(desc, gpt_head, &gpt_pte) != 1)
+	gpt = gpt_get(desc);
+	if (!gpt)
 		return -EINVAL;
 
-	guid_bin = gpt_head->disk_guid.b;
+	guid_bin = gpt->head.disk_guid.b;
 	uuid_bin_to_str(guid_bin, guid, UUID_STR_FORMAT_GUID);
 
-	/* Remember to free pte */
-	free(gpt_pte);
+	gpt_put(gpt);
 	return 0;
 }
 
 void part_print_efi(struct blk_desc *desc)
 {
-	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, desc->blksz);
-	gpt_entry *gpt_pte = NULL;
+	struct gpt_table *gpt;
+	gpt_header *gpt_head;
+	gpt_entry *gpt_pte;
 	int i = 0;
 	unsigned char *uuid;
 
-	/* This function validates AND fills in the GPT header and PTE */
-	if (find_valid_gpt(desc, gpt_head, &gpt_pte) != 1)
+	gpt = gpt_get(desc);
+	if (!gpt)
 		return;
+	gpt_head = &gpt->head;
+	gpt_pte = gpt->pte;
 
 	debug("%s: gpt-entry at %p\n", __func__, gpt_pte);
 
@@ -254,16 +425,15 @@ void part_print_efi(struct blk_desc *desc)
 		printf("\tguid:\t%pUl\n", uuid);
 	}
 
-	/* Remember to free pte */
-	free(gpt_pte);
+	gpt_put(gpt);
 	return;
 }
 
 int part_get_info_efi(struct blk_desc *desc, int part,
 		      struct disk_partition *info)
 {
-	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, desc->blksz);
-	gpt_entry *gpt_pte = NULL;
+	struct gpt_table *gpt;
+	gpt_entry *gpt_pte;
 
 	/* "part" argument must be at least 1 */
 	if (part < 1) {
@@ -271,14 +441,15 @@ int part_get_info_efi(struct blk_desc *desc, int part,
 		return -EINVAL;
 	}
 
-	/* This function validates AND fills in the GPT header and PTE */
-	if (find_valid_gpt(desc, gpt_head, &gpt_pte) != 1)
+	gpt = gpt_get(desc);
+	if (!gpt)
 		return -EINVAL;
+	gpt_pte = gpt->pte;
 
-	if (part > le32_to_cpu(gpt_head->num_partition_entries) ||
+	if (part > le32_to_cpu(gpt->head.num_partition_entries) ||
 	    !is_pte_valid(&gpt_pte[part - 1])) {
 		log_debug("Invalid partition number %d\n", part);
-		free(gpt_pte);
+		gpt_put(gpt);
 		return -EPERM;
 	}
 
@@ -307,11 +478,27 @@ int part_get_info_efi(struct blk_desc *desc, int part,
 	log_debug("start 0x" LBAF ", size 0x" LBAF ", name %s\n", info->start,
 		  info->size, info->name);
 
-	/* Remember to free pte */
-	free(gpt_pte);
+	gpt_put(gpt);
 	return 0;
 }
 
+static int part_find_name_efi(struct blk_desc *desc, const char *name)
+{
+	struct gpt_table *gpt;
+	uint slot;
+	int ret;
+
+	gpt = gpt_get(desc);
+	if (!gpt)
+		return -EINVAL;
+
+	slot = gpt_name_slot(gpt, name);
+	ret = gpt->name_idx[slot] ? gpt->name_idx[slot] : -ENOENT;
+	gpt_put(gpt);
+
+	return ret;
+}
+
 static int part_test_efi(struct blk_desc *desc)
 {
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(legacy_mbr, legacymbr, 1, desc->blksz);
@@ -1200,6 +1387,7 @@ U_BOOT_PART_TYPE(a_efi) = {
 	.part_type	= PART_TYPE_EFI,
 	.max_entries	= GPT_ENTRY_NUMBERS,
 	.get_info	= part_get_info_ptr(part_get_info_efi),
+	.find_name	= part_find_name_efi,
 	.print		= part_print_ptr(part_print_efi),
 	.test		= part_test_efi,
 };
@@ -11,7 +11,9 @@
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
+#include <memalign.h>
 #include <part.h>
+#include <stat.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
@@ -19,6 +21,19 @@
 
 #define blk_get_ops(dev)	((struct blk_ops *)(dev)->driver->ops)
 
+STAT_COUNTER_DEFINE(blk, reads);
+STAT_COUNTER_DEFINE(blk, read_blocks);
+STAT_COUNTER_DEFINE(blk, cache_hits);
+STAT_HIST_DEFINE(blk, read_size);
+STAT_COUNTER_DEFINE(blk, writes);
+STAT_COUNTER_DEFINE(blk, write_blocks);
+STAT_COUNTER_DEFINE(blk, unchanged_blocks);
+
+enum {
+	/* Number of blocks compared at a time by blk_dwrite_changed() */
+	BLK_CHANGED_CHUNK	= 128,
+};
+
 static struct {
 	enum uclass_id id;
 	const char *name;
@@ -437,9 +452,14 @@ long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
 	if (!ops->read)
 		return -ENOSYS;
 
+	STAT_INC(blk, reads);
+	STAT_ADD(blk, read_blocks, blkcnt);
+	STAT_HIST_ADD(blk, read_size, blkcnt);
 	if (blkcache_read(desc->uclass_id, desc->devnum,
-			  start, blkcnt, desc->blksz, buf))
+			  start, blkcnt, desc->blksz, buf)) {
+		STAT_INC(blk, cache_hits);
 		return blkcnt;
+	}
 
 	if (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb) {
 		struct blk_bounce_buffer bbstate = { .dev = dev };
@@ -476,7 +496,10 @@ long blk_write(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 	if (!ops->write)
 		return -ENOSYS;
 
+	STAT_INC(blk, writes);
+	STAT_ADD(blk, write_blocks, blkcnt);
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	part_efi_cache_write(desc, start, blkcnt);
 
 	if (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb) {
 		struct blk_bounce_buffer bbstate = { .dev = dev };
@@ -509,6 +532,7 @@ long blk_erase(struct udevice *dev, lbaint_t start, lbaint_t blkcnt)
 		return -ENOSYS;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	part_efi_cache_write(desc, start, blkcnt);
 
 	return ops->erase(dev, start, blkcnt);
 }
@@ -530,6 +554,82 @@ ulong blk_derase(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt)
 	return blk_erase(desc->bdev, start, blkcnt);
 }
 
+/**
+ * blk_write_chunk_changed() - Write the blocks of a chunk which have changed
+ *
+ * @desc: Block device to write to
+ * @start: First block of the chunk
+ * @count: Number of blocks in the chunk
+ * @buf: New contents of the chunk
+ * @old: Old contents of the chunk
+ * Return: number of blocks dealt with, or -ve on error
+ */
+static long blk_write_chunk_changed(struct blk_desc *desc, lbaint_t start,
+				    lbaint_t count, const char *buf,
+				    const char *old)
+{
+	ulong blksz = desc->blksz;
+	lbaint_t i, run;
+	bool same;
+	long ret;
+
+	for (i = 0; i < count; i += run) {
+		/* find the run of blocks which are all the same, or all not */
+		same = !memcmp(buf + i * blksz, old + i * blksz, blksz);
+		for (run = 1; i + run < count; run++) {
+			ulong ofs = (i + run) * blksz;
+
+			if (!memcmp(buf + ofs, old + ofs, blksz) != same)
+				break;
+		}
+		if (same) {
+			STAT_ADD(blk, unchanged_blocks, run);
+			continue;
+		}
+
+		ret = blk_write(desc->bdev, start + i, run, buf + i * blksz);
+		if (ret != run)
+			return ret < 0 ? ret : i + ret;
+	}
+
+	return count;
+}
+
+long blk_dwrite_changed(struct blk_desc *desc, lbaint_t start,
+			lbaint_t blkcnt, const void *buffer)
+{
+	const char *buf = buffer;
+	lbaint_t done, count;
+	char *old;
+	long ret;
+
+	count = min_t(lbaint_t, blkcnt, BLK_CHANGED_CHUNK);
+	old = malloc_cache_aligned(count * desc->blksz);
+	if (!old)
+		return blk_write(desc->bdev, start, blkcnt, buffer);
+
+	for (done = 0; done < blkcnt; done += count) {
+		const char *src = buf + done * desc->blksz;
+
+		count = min_t(lbaint_t, blkcnt - done, BLK_CHANGED_CHUNK);
+		if (blk_read(desc->bdev, start + done, count, old) == count)
+			ret = blk_write_chunk_changed(desc, start + done, count,
+						      src, old);
+		else
+			ret = blk_write(desc->bdev, start + done, count, src);
+		if (ret != count) {
+			if (ret >= 0)
+				ret += done;
+			goto out;
+		}
+	}
+	ret = blkcnt;
+out:
+	free(old);
+
+	return ret;
+}
+
 int blk_find_from_parent(struct udevice *parent, struct udevice **devp)
 {
 	struct udevice *dev;
@@ -851,9 +951,17 @@ static int blk_post_probe(struct udevice *dev)
 	return 0;
 }
 
+static int blk_pre_remove(struct udevice *dev)
+{
+	part_efi_cache_invalidate(dev_get_uclass_plat(dev));
+
+	return 0;
+}
+
 UCLASS_DRIVER(blk) = {
 	.id		= UCLASS_BLK,
 	.name		= "blk",
 	.post_probe	= blk_post_probe,
+	.pre_remove	= blk_pre_remove,
 	.per_device_plat_auto	= sizeof(struct blk_desc),
 };
@@ -11,6 +11,8 @@
 #include <common.h>
 #include <errno.h>
 #include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -19,6 +21,130 @@
 #include <dm/util.h>
 #include <fdtdec.h>
 #include <linux/compiler.h>
+#include <linux/log2.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#if CONFIG_IS_ENABLED(DM_MATCH_INDEX)
+/**
+ * struct dm_match_slot - Slot in the compatible-string hash table
+ *
+ * Indexes are used rather than pointers so that the table does not depend on
+ * where the linker lists happen to be.
+ *
+ * @hash: Hash of the compatible string
+ * @drv: Index of the driver in the driver linker list, plus 1 (0 if unused)
+ * @id: Index of the compatible string in the driver's of_match table
+ */
+struct dm_match_slot {
+	u32 hash;
+	u16 drv;
+	u16 id;
+};
+
+/**
+ * struct dm_match_index - Lookup index for drivers and uclass drivers
+ *
+ * @mask: Number of slots in @slot, minus 1 (always a power of two)
+ * @uclass: Index of each uclass driver in its linker list, or -1 if none
+ * @slot: Open-addressed (linear probing) table of compatible strings
+ */
+struct dm_match_index {
+	uint mask;
+	s16 uclass[UCLASS_COUNT];
+	struct dm_match_slot slot[];
+};
+
+static u32 lists_hash_compat(const char *str)
+{
+	u32 hash = 2166136261u;
+
+	while (*str) {
+		hash ^= (u8)*str++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/* Set if the index could not be allocated, so that it is not tried again */
+static bool dm_match_index_failed;
+
+static struct dm_match_index *lists_match_index_build(void)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct uclass_driver *uc_drv =
+		ll_entry_start(struct uclass_driver, uclass_driver);
+	const int n_uc = ll_entry_count(struct uclass_driver, uclass_driver);
+	const struct udevice_id *of_id;
+	struct dm_match_index *idx;
+	uint count = 0, size;
+	int i;
+
+	for (i = 0; i < n_ents; i++) {
+		for (of_id = driver[i].of_match; of_id && of_id->compatible;
+		     of_id++)
+			count++;
+	}
+	size = max(16UL, roundup_pow_of_two(count * 2 + 1));
+	idx = calloc(1, sizeof(*idx) + size * sizeof(struct dm_match_slot));
+	if (!idx)
+		return NULL;
+	idx->mask = size - 1;
+
+	/*
+	 * Insert in linker-list order. With linear probing a later driver with
+	 * the same compatible string always lands further along the probe
+	 * sequence, so lookups still return the first driver, as the linear
+	 * scan did.
+	 */
+	for (i = 0; i < n_ents; i++) {
+		of_id = driver[i].of_match;
+		for (; of_id && of_id->compatible; of_id++) {
+			u32 hash = lists_hash_compat(of_id->compatible);
+			uint pos = hash & idx->mask;
+
+			while (idx->slot[pos].drv)
+				pos = (pos + 1) & idx->mask;
+			idx->slot[pos].hash = hash;
+			idx->slot[pos].drv = i + 1;
+			idx->slot[pos].id = of_id - driver[i].of_match;
+		}
+	}
+
+	for (i = 0; i < UCLASS_COUNT; i++)
+		idx->uclass[i] = -1;
+	for (i = n_uc - 1; i >= 0; i--) {
+		if (uc_drv[i].id >= 0 && uc_drv[i].id < UCLASS_COUNT)
+			idx->uclass[uc_drv[i].id] = i;
+	}
+	log_debug("Driver match index: %u compatibles, %u slots\n", count,
+		  size);
+
+	return idx;
+}
+
+static struct dm_match_index *lists_match_index(void)
+{
+	struct dm_match_index *idx = gd_dm_match_index();
+
+	/*
+	 * Before relocation the few pre-relocation devices do not justify the
+	 * space the index would take in the small early malloc() area
+	 */
+	if (idx || !(gd->flags & GD_FLG_RELOC) || dm_match_index_failed)
+		return idx;
+
+	idx = lists_match_index_build();
+	if (idx)
+		gd_set_dm_match_index(idx);
+	else
+		dm_match_index_failed = true;
+
+	return idx;
+}
+#endif
 
 struct driver *lists_driver_lookup_name(const char *name)
 {
@@ -43,6 +169,15 @@ struct uclass_driver *lists_uclass_lookup(enum uclass_id id)
 	const int n_ents = ll_entry_count(struct uclass_driver, uclass_driver);
 	struct uclass_driver *entry;
 
+#if CONFIG_IS_ENABLED(DM_MATCH_INDEX)
+	struct dm_match_index *idx = lists_match_index();
+
+	if (idx) {
+		if (id < 0 || id >= UCLASS_COUNT || idx->uclass[id] < 0)
+			return NULL;
+		return uclass + idx->uclass[id];
+	}
+#endif
 	for (entry = uclass; entry != uclass + n_ents; entry++) {
 		if (entry->id == id)
 			return entry;
@@ -181,6 +316,49 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
+int lists_driver_match_compat(const char *compat, struct driver **drvp,
+			      const struct udevice_id **idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+
+#if CONFIG_IS_ENABLED(DM_MATCH_INDEX)
+	struct dm_match_index *idx = lists_match_index();
+
+	if (idx) {
+		u32 hash = lists_hash_compat(compat);
+		uint pos;
+
+		for (pos = hash & idx->mask; idx->slot[pos].drv;
+		     pos = (pos + 1) & idx->mask) {
+			struct dm_match_slot *slot = &idx->slot[pos];
+			const struct udevice_id *of_id;
+
+			if (slot->hash != hash)
+				continue;
+			entry = driver + slot->drv - 1;
+			of_id = entry->of_match + slot->id;
+			if (!strcmp(of_id->compatible, compat)) {
+				*drvp = entry;
+				*idp = of_id;
+				return 0;
+			}
+		}
+
+		return -ENOENT;
+	}
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, idp, compat)) {
+			*drvp = entry;
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		   struct driver *drv, bool pre_reloc_only)
 {
@@ -223,20 +401,24 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 			  compat);
 
 		id = NULL;
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			if (drv) {
+		if (drv) {
+			for (entry = driver; entry != driver + n_ents; entry++) {
 				if (drv != entry)
 					continue;
 				if (!entry->of_match)
 					break;
+				ret = driver_check_compatible(entry->of_match,
+							      &id, compat);
+				if (!ret)
+					break;
 			}
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
+			if (entry == driver + n_ents)
+				continue;
+		} else {
+			ret = lists_driver_match_compat(compat, &entry, &id);
+			if (ret)
+				continue;
 		}
-		if (entry == driver + n_ents)
-			continue;
 
 		if (pre_reloc_only) {
 			if (!ofnode_pre_reloc(node) &&
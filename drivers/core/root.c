@@ -9,6 +9,7 @@
 #define LOG_CATEGORY UCLASS_ROOT
 
 #include <common.h>
+#include <bootstage.h>
 #include <errno.h>
 #include <fdtdec.h>
 #include <log.h>
@@ -326,7 +327,14 @@ static int dm_scan(bool pre_reloc_only)
 	}
 
 	if (CONFIG_IS_ENABLED(OF_REAL)) {
+		bool reloc = gd->flags & GD_FLG_RELOC;
+
+		bootstage_start(reloc ? BOOTSTAGE_ID_ACCUM_DM_BIND_R :
+				BOOTSTAGE_ID_ACCUM_DM_BIND_F,
+				reloc ? "dm_bind_r" : "dm_bind_f");
 		ret = dm_extended_scan(pre_reloc_only);
+		bootstage_accum(reloc ? BOOTSTAGE_ID_ACCUM_DM_BIND_R :
+				BOOTSTAGE_ID_ACCUM_DM_BIND_F);
 		if (ret) {
 			debug("dm_extended_scan() failed: %d\n", ret);
 			return ret;
@@ -23,6 +23,290 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+enum uclass_key_t {
+	UCLASS_KEY_SEQ,
+	UCLASS_KEY_NODE,
+	UCLASS_KEY_PHANDLE,
+};
+
+/**
+ * struct uclass_hent - Entry in a uclass device index
+ *
+ * @next: Next entry in the same bucket
+ * @dev: Device this entry refers to
+ * @key: Sequence number, ofnode (as of_offset) or phandle of @dev
+ * @type: Type of @key (enum uclass_key_t)
+ */
+struct uclass_hent {
+	struct uclass_hent *next;
+	struct udevice *dev;
+	long key;
+	u8 type;
+};
+
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+#define UCLASS_INDEX_MIN_BUCKETS	16
+
+static uint uclass_index_hash(enum uclass_key_t type, long key, uint mask)
+{
+	ulong hash = (ulong)key * 0x9e3779b1UL + type;
+
+	return (hash ^ (hash >> 16)) & mask;
+}
+
+/* Check whether the index of @uc is being kept up to date */
+static bool uclass_index_live(struct uclass *uc)
+{
+	return uc->index.built && !uc->index.broken;
+}
+
+static void uclass_index_free(struct uclass *uc)
+{
+	struct uclass_index *idx = &uc->index;
+	struct uclass_hent *ent, *next;
+	uint i;
+
+	if (idx->bucket) {
+		for (i = 0; i <= idx->mask; i++) {
+			for (ent = idx->bucket[i]; ent; ent = next) {
+				next = ent->next;
+				free(ent);
+			}
+		}
+		free(idx->bucket);
+	}
+	idx->bucket = NULL;
+	idx->count = 0;
+	idx->mask = 0;
+}
+
+/* Append @ent to its bucket, keeping entries with the same key in order */
+static void uclass_index_link(struct uclass_hent **bucket, uint mask,
+			      struct uclass_hent *ent)
+{
+	struct uclass_hent **pp;
+
+	pp = &bucket[uclass_index_hash(ent->type, ent->key, mask)];
+	while (*pp)
+		pp = &(*pp)->next;
+	ent->next = NULL;
+	*pp = ent;
+}
+
+static int uclass_index_grow(struct uclass *uc)
+{
+	struct uclass_index *idx = &uc->index;
+	struct uclass_hent **bucket, *ent, *next;
+	uint size, i;
+
+	size = idx->bucket ? (idx->mask + 1) * 2 : UCLASS_INDEX_MIN_BUCKETS;
+	bucket = calloc(size, sizeof(*bucket));
+	if (!bucket)
+		return -ENOMEM;
+	if (idx->bucket) {
+		for (i = 0; i <= idx->mask; i++) {
+			for (ent = idx->bucket[i]; ent; ent = next) {
+				next = ent->next;
+				uclass_index_link(bucket, size - 1, ent);
+			}
+		}
+		free(idx->bucket);
+	}
+	idx->bucket = bucket;
+	idx->mask = size - 1;
+
+	return 0;
+}
+
+static int uclass_index_add(struct uclass *uc, enum uclass_key_t type,
+			    long key, struct udevice *dev)
+{
+	struct uclass_index *idx = &uc->index;
+	struct uclass_hent *ent;
+
+	if (!idx->bucket || idx->count > idx->mask) {
+		if (uclass_index_grow(uc))
+			return -ENOMEM;
+	}
+	ent = malloc(sizeof(*ent));
+	if (!ent)
+		return -ENOMEM;
+	ent->dev = dev;
+	ent->key = key;
+	ent->type = type;
+	uclass_index_link(idx->bucket, idx->mask, ent);
+	idx->count++;
+
+	return 0;
+}
+
+static void uclass_index_del(struct uclass *uc, enum uclass_key_t type,
+			     long key, struct udevice *dev)
+{
+	struct uclass_index *idx = &uc->index;
+	struct uclass_hent **pp, *ent;
+
+	if (!idx->bucket)
+		return;
+	pp = &idx->bucket[uclass_index_hash(type, key, idx->mask)];
+	for (; (ent = *pp); pp = &ent->next) {
+		if (ent->dev == dev && ent->type == type && ent->key == key) {
+			*pp = ent->next;
+			free(ent);
+			idx->count--;
+			return;
+		}
+	}
+}
+
+static struct udevice *uclass_index_find(struct uclass *uc,
+					 enum uclass_key_t type, long key)
+{
+	struct uclass_index *idx = &uc->index;
+	struct uclass_hent *ent;
+
+	if (!idx->bucket)
+		return NULL;
+	ent = idx->bucket[uclass_index_hash(type, key, idx->mask)];
+	for (; ent; ent = ent->next) {
+		if (ent->type == type && ent->key == key)
+			return ent->dev;
+	}
+
+	return NULL;
+}
+
+static uint uclass_index_phandle(struct udevice *dev)
+{
+	if (!CONFIG_IS_ENABLED(OF_REAL) || !dev_has_ofnode(dev))
+		return 0;
+
+	return dev_read_phandle(dev);
+}
+
+/* Add the ofnode and phandle of @dev to the index */
+static int uclass_index_add_node(struct uclass *uc, struct udevice *dev)
+{
+	uint phandle;
+	int ret = 0;
+
+	if (dev_has_ofnode(dev))
+		ret = uclass_index_add(uc, UCLASS_KEY_NODE,
+				       dev_ofnode(dev).of_offset, dev);
+	phandle = uclass_index_phandle(dev);
+	if (!ret && phandle)
+		ret = uclass_index_add(uc, UCLASS_KEY_PHANDLE, phandle, dev);
+
+	return ret;
+}
+
+static void uclass_index_del_node(struct uclass *uc, struct udevice *dev)
+{
+	uint phandle;
+
+	if (dev_has_ofnode(dev))
+		uclass_index_del(uc, UCLASS_KEY_NODE,
+				 dev_ofnode(dev).of_offset, dev);
+	phandle = uclass_index_phandle(dev);
+	if (phandle)
+		uclass_index_del(uc, UCLASS_KEY_PHANDLE, phandle, dev);
+}
+
+static void uclass_index_drop(struct uclass *uc)
+{
+	/* Fall back to walking the device list from now on */
+	log_debug("Dropping device index for uclass '%s'\n", uc->uc_drv->name);
+	uclass_index_free(uc);
+	uc->index.broken = true;
+}
+
+static void uclass_index_add_dev(struct udevice *dev)
+{
+	struct uclass *uc = dev->uclass;
+	int ret = 0;
+
+	if (!uclass_index_live(uc))
+		return;
+	if (dev->seq_ != -1)
+		ret = uclass_index_add(uc, UCLASS_KEY_SEQ, dev->seq_, dev);
+	if (!ret)
+		ret = uclass_index_add_node(uc, dev);
+	if (ret)
+		uclass_index_drop(uc);
+}
+
+static void uclass_index_del_dev(struct udevice *dev)
+{
+	struct uclass *uc = dev->uclass;
+
+	if (!uclass_index_live(uc))
+		return;
+	if (dev->seq_ != -1)
+		uclass_index_del(uc, UCLASS_KEY_SEQ, dev->seq_, dev);
+	uclass_index_del_node(uc, dev);
+}
+
+/*
+ * Check whether the index can be used, building it on first use after
+ * relocation. Before relocation the device list is walked instead: growing
+ * the index there would leak the old buckets in the simple malloc() area.
+ */
+static bool uclass_index_valid(struct uclass *uc)
+{
+	struct udevice *dev;
+
+	if (uc->index.broken || !(gd->flags & GD_FLG_RELOC))
+		return false;
+	if (!uc->index.built) {
+		uc->index.built = true;
+		uclass_foreach_dev(dev, uc)
+			uclass_index_add_dev(dev);
+	}
+
+	return !uc->index.broken;
+}
+
+#if CONFIG_IS_ENABLED(OF_REAL)
+void dev_set_ofnode(struct udevice *dev, ofnode node)
+{
+	struct uclass *uc = dev->uclass;
+	bool indexed;
+
+	/* Devices which are not bound yet are added to the index at bind */
+	indexed = uc && (dev_get_flags(dev) & DM_FLAG_BOUND) &&
+		uclass_index_live(uc);
+	if (indexed)
+		uclass_index_del_node(uc, dev);
+	dev->node_ = node;
+	if (indexed && uclass_index_add_node(uc, dev))
+		uclass_index_drop(uc);
+}
+#endif
+#else
+static bool uclass_index_valid(struct uclass *uc)
+{
+	return false;
+}
+
+static void uclass_index_free(struct uclass *uc)
+{
+}
+
+static struct udevice *uclass_index_find(struct uclass *uc,
+					 enum uclass_key_t type, long key)
+{
+	return NULL;
+}
+
+static void uclass_index_add_dev(struct udevice *dev)
+{
+}
+
+static void uclass_index_del_dev(struct udevice *dev)
+{
+}
+#endif
+
 struct uclass *uclass_find(enum uclass_id key)
 {
 	struct uclass *uc;
@@ -137,6 +421,7 @@ int uclass_destroy(struct uclass *uc)
 	list_del(&uc->sibling_node);
 	if (uc_drv->priv_auto)
 		free(uclass_get_priv(uc));
+	uclass_index_free(uc);
 	free(uc);
 
 	return 0;
@@ -328,6 +613,13 @@ int uclass_find_next_free_seq(struct uclass *uc)
 	return max + 1;
 }
 
+void uclass_set_device_seq(struct udevice *dev, int seq)
+{
+	uclass_index_del_dev(dev);
+	dev->seq_ = seq;
+	uclass_index_add_dev(dev);
+}
+
 int uclass_find_device_by_seq(enum uclass_id id, int seq, struct udevice **devp)
 {
 	struct uclass *uc;
@@ -342,6 +634,11 @@ int uclass_find_device_by_seq(enum uclass_id id, int seq, struct udevice **devp)
 	if (ret)
 		return ret;
 
+	if (uclass_index_valid(uc)) {
+		*devp = uclass_index_find(uc, UCLASS_KEY_SEQ, seq);
+		log_debug("   - %s\n", *devp ? "found" : "not found");
+		return *devp ? 0 : -ENODEV;
+	}
 	uclass_foreach_dev(dev, uc) {
 		log_debug("   - %d '%s'\n", dev->seq_, dev->name);
 		if (dev->seq_ == seq) {
@@ -394,6 +691,12 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	if (ret)
 		return ret;
 
+	if (uclass_index_valid(uc)) {
+		*devp = uclass_index_find(uc, UCLASS_KEY_NODE, node.of_offset);
+		if (!*devp)
+			ret = -ENODEV;
+		goto done;
+	}
 	uclass_foreach_dev(dev, uc) {
 		log(LOGC_DM, LOGL_DEBUG_CONTENT, "      - checking %s\n",
 		    dev->name);
@@ -423,6 +726,10 @@ static int uclass_find_device_by_phandle_id(enum uclass_id id,
 	if (ret)
 		return ret;
 
+	if (uclass_index_valid(uc)) {
+		*devp = uclass_index_find(uc, UCLASS_KEY_PHANDLE, find_phandle);
+		return *devp ? 0 : -ENODEV;
+	}
 	uclass_foreach_dev(dev, uc) {
 		uint phandle;
 
@@ -694,6 +1001,7 @@ int uclass_bind_device(struct udevice *dev)
 
 	uc = dev->uclass;
 	list_add_tail(&dev->uclass_node, &uc->dev_head);
+	uclass_index_add_dev(dev);
 
 	if (dev->parent) {
 		struct uclass_driver *uc_drv = dev->parent->uclass->uc_drv;
@@ -708,6 +1016,7 @@ int uclass_bind_device(struct udevice *dev)
 	return 0;
 err:
 	/* There is no need to undo the parent's post_bind call */
+	uclass_index_del_dev(dev);
 	list_del(&dev->uclass_node);
 
 	return ret;
@@ -731,6 +1040,7 @@ int uclass_pre_unbind_device(struct udevice *dev)
 
 int uclass_unbind_device(struct udevice *dev)
 {
+	uclass_index_del_dev(dev);
 	list_del(&dev->uclass_node);
 
 	return 0;
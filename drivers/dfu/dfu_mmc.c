@@ -68,8 +68,12 @@ static int mmc_block_op(enum dfu_op op, struct dfu_entity *dfu,
 		n = blk_dread(mmc_get_blk_desc(mmc), blk_start, blk_count, buf);
 		break;
 	case DFU_OP_WRITE:
-		n = blk_dwrite(mmc_get_blk_desc(mmc), blk_start, blk_count,
-			       buf);
+		if (IS_ENABLED(CONFIG_DFU_MMC_SKIP_UNCHANGED))
+			n = blk_dwrite_changed(mmc_get_blk_desc(mmc), blk_start,
+					       blk_count, buf);
+		else
+			n = blk_dwrite(mmc_get_blk_desc(mmc), blk_start,
+				       blk_count, buf);
 		break;
 	default:
 		pr_err("Operation not supported\n");
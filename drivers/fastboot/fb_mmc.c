@@ -135,10 +135,17 @@ static lbaint_t fb_mmc_blk_write(struct blk_desc *block_dev, lbaint_t start,
 	for (i = 0; i < blkcnt; i += FASTBOOT_MAX_BLK_WRITE) {
 		cur_blkcnt = min((int)blkcnt - i, FASTBOOT_MAX_BLK_WRITE);
 		if (buffer) {
+			const void *src = buffer + (i * block_dev->blksz);
+
 			if (fastboot_progress_callback)
 				fastboot_progress_callback("writing");
-			blks_written = blk_dwrite(block_dev, blk, cur_blkcnt,
-						  buffer + (i * block_dev->blksz));
+			if (IS_ENABLED(CONFIG_FASTBOOT_MMC_SKIP_UNCHANGED))
+				blks_written = blk_dwrite_changed(block_dev, blk,
+								  cur_blkcnt,
+								  src);
+			else
+				blks_written = blk_dwrite(block_dev, blk,
+							  cur_blkcnt, src);
 		} else {
 			if (fastboot_progress_callback)
 				fastboot_progress_callback("erasing");
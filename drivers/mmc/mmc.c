@@ -17,6 +17,7 @@
 #include <errno.h>
 #include <mmc.h>
 #include <part.h>
+#include <stat.h>
 #include <linux/bitops.h>
 #include <linux/delay.h>
 #include <linux/printk.h>
@@ -467,6 +468,11 @@ static int mmc_get_b_max(struct mmc *mmc, void *dst, lbaint_t blkcnt)
 }
 #endif
 
+STAT_COUNTER_DEFINE(mmc, reads);
+STAT_COUNTER_DEFINE(mmc, read_blocks);
+STAT_COUNTER_DEFINE(mmc, read_cmds);
+STAT_COUNTER_DEFINE(mmc, read_errors);
+
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *dst)
 #else
@@ -512,10 +518,14 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 
 	b_max = mmc_get_b_max(mmc, dst, blkcnt);
 
+	STAT_INC(mmc, reads);
+	STAT_ADD(mmc, read_blocks, blkcnt);
 	do {
 		cur = (blocks_todo > b_max) ? b_max : blocks_todo;
+		STAT_INC(mmc, read_cmds);
 		if (mmc_read_blocks(mmc, dst, start, cur) != cur) {
 			pr_debug("%s: Failed to read blocks\n", __func__);
+			STAT_INC(mmc, read_errors);
 			return 0;
 		}
 		blocks_todo -= cur;
@@ -2708,6 +2718,8 @@ static int mmc_startup(struct mmc *mmc)
 	bdesc->revision[0] = 0;
 #endif
 
+	/* This may be a different card, so drop any GPT read from the last */
+	part_efi_cache_invalidate(bdesc);
 #if !defined(CONFIG_DM_MMC) && (!defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBDISK_SUPPORT))
 	part_init(bdesc);
 #endif
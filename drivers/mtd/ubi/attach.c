@@ -832,6 +832,9 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		ai->bad_peb_count += 1;
 		return 0;
 	}
+#ifdef __UBOOT__
+	ubi_io_read_hdrs(ubi, pnum);
+#endif
 
 	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
 	if (err < 0)
@@ -1214,6 +1217,27 @@ static void destroy_ai(struct ubi_attach_info *ai)
 	kfree(ai);
 }
 
+#ifdef __UBOOT__
+/* Read the headers of each PEB in one go, see ubi_io_read_hdrs() */
+static void hdrs_buf_alloc(struct ubi_device *ubi)
+{
+	ubi->hdrs_pnum = -1;
+	ubi->hdrs_buf = NULL;
+	if (IS_ENABLED(CONFIG_MTD_UBI_READ_HDRS))
+		ubi->hdrs_buf = kmalloc(ubi->leb_start, GFP_KERNEL);
+}
+
+static void hdrs_buf_free(struct ubi_device *ubi)
+{
+	kfree(ubi->hdrs_buf);
+	ubi->hdrs_buf = NULL;
+	ubi->hdrs_pnum = -1;
+}
+#else
+static inline void hdrs_buf_alloc(struct ubi_device *ubi) {}
+static inline void hdrs_buf_free(struct ubi_device *ubi) {}
+#endif
+
 /**
  * scan_all - scan entire MTD device.
  * @ubi: UBI device description object
@@ -1242,6 +1266,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	if (!vidh)
 		goto out_ech;
 
+	hdrs_buf_alloc(ubi);
 	for (pnum = start; pnum < ubi->peb_count; pnum++) {
 		cond_resched();
 
@@ -1250,6 +1275,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		if (err < 0)
 			goto out_vidh;
 	}
+	hdrs_buf_free(ubi);
 
 	ubi_msg(ubi, "scanning is finished");
 
@@ -1294,6 +1320,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	return 0;
 
 out_vidh:
+	hdrs_buf_free(ubi);
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
@@ -1351,6 +1378,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 	if (!vidh)
 		goto out_ech;
 
+	hdrs_buf_alloc(ubi);
 	for (pnum = 0; pnum < UBI_FM_MAX_START; pnum++) {
 		int vol_id = -1;
 		unsigned long long sqnum = -1;
@@ -1366,6 +1394,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 			fm_anchor = pnum;
 		}
 	}
+	hdrs_buf_free(ubi);
 
 	ubi_free_vid_hdr(ubi, vidh);
 	kfree(ech);
@@ -1381,6 +1410,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 	return ubi_scan_fastmap(ubi, *ai, fm_anchor);
 
 out_vidh:
+	hdrs_buf_free(ubi);
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
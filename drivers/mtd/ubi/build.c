@@ -31,6 +31,7 @@
 #include <linux/slab.h>
 #include <linux/major.h>
 #else
+#include <bootstage.h>
 #include <linux/bug.h>
 #include <linux/log2.h>
 #include <linux/printk.h>
@@ -999,7 +1000,9 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num,
 	if (!ubi->fm_buf)
 		goto out_free;
 #endif
+	bootstage_start(BOOTSTAGE_ID_ACCUM_UBI_ATTACH, "ubi_attach");
 	err = ubi_attach(ubi, 0);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_UBI_ATTACH);
 	if (err) {
 		ubi_err(ubi, "failed to attach mtd%d, error %d",
 			mtd->index, err);
@@ -1061,6 +1064,19 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num,
 
 	spin_unlock(&ubi->wl_lock);
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	/*
+	 * If the device had to be scanned, write a fastmap now so that the next
+	 * attach does not have to scan it again. This does nothing if fastmap
+	 * is disabled for this device.
+	 */
+	if (!ubi->fm) {
+		err = ubi_update_fastmap(ubi);
+		if (err)
+			ubi_msg(ubi, "Unable to write a new fastmap: %i", err);
+	}
+#endif
+
 	ubi_devices[ubi_num] = ubi;
 	ubi_notify_all(ubi, UBI_VOLUME_ADDED, NULL);
 	return ubi_num;
@@ -136,6 +136,14 @@ int ubi_io_read(const struct ubi_device *ubi, void *buf, int pnum, int offset,
 	if (err)
 		return err;
 
+#ifdef __UBOOT__
+	if (ubi->hdrs_buf && pnum == ubi->hdrs_pnum &&
+	    offset + len <= ubi->leb_start) {
+		memcpy(buf, ubi->hdrs_buf + offset, len);
+		return 0;
+	}
+#endif
+
 	/*
 	 * Deliberately corrupt the buffer to improve robustness. Indeed, if we
 	 * do not do this, the following may happen:
@@ -211,6 +219,38 @@ retry:
 	return err;
 }
 
+#ifdef __UBOOT__
+/**
+ * ubi_io_read_hdrs - read the headers of a physical eraseblock in one go.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock number to read from
+ *
+ * While attaching, the EC and VID headers of every physical eraseblock are
+ * read one after the other, with two mtd_read() calls. This function reads
+ * everything in front of the data with one call into @ubi->hdrs_buf, so that
+ * the following header reads come from memory. The flash still loads every
+ * page in that range, so this only saves the overhead of a call, plus one
+ * page load when both headers are in the same page.
+ *
+ * Nothing is kept unless the read was clean, so bit-flips and ECC errors are
+ * still reported against the header they affect by a separate read.
+ */
+void ubi_io_read_hdrs(struct ubi_device *ubi, int pnum)
+{
+	size_t read;
+	int err;
+
+	ubi->hdrs_pnum = -1;
+	if (!ubi->hdrs_buf)
+		return;
+
+	err = mtd_read(ubi->mtd, (loff_t)pnum * ubi->peb_size, ubi->leb_start,
+		       &read, ubi->hdrs_buf);
+	if (!err && read == ubi->leb_start)
+		ubi->hdrs_pnum = pnum;
+}
+#endif
+
 /**
  * ubi_io_write - write data to a physical eraseblock.
  * @ubi: UBI device description object
@@ -527,6 +527,8 @@ struct ubi_debug_info {
  *
  * @peb_buf: a buffer of PEB size used for different purposes
  * @buf_mutex: protects @peb_buf
+ * @hdrs_buf: headers of PEB @hdrs_pnum, read in one go while attaching
+ * @hdrs_pnum: PEB whose headers are in @hdrs_buf, or -1 if none
  * @ckvol_mutex: serializes static volume checking when opening
  *
  * @dbg: debugging information for this UBI device
@@ -627,6 +629,10 @@ struct ubi_device {
 	void *peb_buf;
 	struct mutex buf_mutex;
 	struct mutex ckvol_mutex;
+#ifdef __UBOOT__
+	void *hdrs_buf;
+	int hdrs_pnum;
+#endif
 
 	struct ubi_debug_info dbg;
 };
@@ -893,6 +899,9 @@ int ubi_io_is_bad(const struct ubi_device *ubi, int pnum);
 int ubi_io_mark_bad(const struct ubi_device *ubi, int pnum);
 int ubi_io_read_ec_hdr(struct ubi_device *ubi, int pnum,
 		       struct ubi_ec_hdr *ec_hdr, int verbose);
+#ifdef __UBOOT__
+void ubi_io_read_hdrs(struct ubi_device *ubi, int pnum);
+#endif
 int ubi_io_write_ec_hdr(struct ubi_device *ubi, int pnum,
 			struct ubi_ec_hdr *ec_hdr);
 int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
@@ -13,6 +13,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <memalign.h>
+#include <stat.h>
 #include <time.h>
 #include <dm/device-internal.h>
 #include <linux/compat.h>
@@ -740,6 +741,11 @@ static int nvme_blk_probe(struct udevice *udev)
 	return 0;
 }
 
+STAT_COUNTER_DEFINE(nvme, reads);
+STAT_COUNTER_DEFINE(nvme, writes);
+STAT_COUNTER_DEFINE(nvme, io_cmds);
+STAT_COUNTER_DEFINE(nvme, io_errors);
+
 static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 			 lbaint_t blkcnt, void *buffer, bool read)
 {
@@ -760,6 +766,10 @@ static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 	flush_dcache_range((unsigned long)buffer,
 			   (unsigned long)buffer + total_len);
 
+	if (read)
+		STAT_INC(nvme, reads);
+	else
+		STAT_INC(nvme, writes);
 	c.rw.opcode = read ? nvme_cmd_read : nvme_cmd_write;
 	c.rw.flags = 0;
 	c.rw.nsid = cpu_to_le32(ns->ns_id);
@@ -786,10 +796,13 @@ static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 		c.rw.length = cpu_to_le16(lbas - 1);
 		c.rw.prp1 = cpu_to_le64(temp_buffer);
 		c.rw.prp2 = cpu_to_le64(prp2);
+		STAT_INC(nvme, io_cmds);
 		status = nvme_submit_sync_cmd(dev->queues[NVME_IO_Q],
 				&c, NULL, IO_TIMEOUT);
-		if (status)
+		if (status) {
+			STAT_INC(nvme, io_errors);
 			break;
+		}
 		temp_len -= (u32)lbas << ns->lba_shift;
 		temp_buffer += lbas << ns->lba_shift;
 	}
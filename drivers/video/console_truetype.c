@@ -8,8 +8,10 @@
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
+#include <stat.h>
 #include <video.h>
 #include <video_console.h>
+#include <linux/list.h>
 
 /* Functions needed by stb_truetype.h */
 static int tt_floor(double val)
@@ -155,6 +157,67 @@ struct console_tt_metrics {
 	double scale;
 };
 
+/* Number of hash chains in the glyph cache; must be a power of two */
+#define GLYPH_HASH_SIZE		64
+
+/**
+ * struct console_tt_glyph - A glyph rendered in the format of the display
+ *
+ * The glyph is keyed on everything which affects its pixels, so that drawing
+ * it from the cache gives exactly the same result as rendering it again.
+ *
+ * @sibling:	Node in the hash chain
+ * @lru:	Node in the LRU list, most recently used first
+ * @font_data:	TrueType font file contents the glyph was rendered from
+ * @font_size:	Font size in pixels
+ * @cp:		Code point
+ * @x_shift:	Sub-pixel offset passed to the renderer
+ * @bpix:	Display colour depth the pixels are converted to
+ * @fg:		true if the glyph is ORed into the display, false to AND it
+ * @bg:		true if the pixel values are inverted
+ * @width:	Width in pixels, 0 for an empty glyph such as ' '
+ * @height:	Height in pixels, 0 for an empty glyph
+ * @xoff:	X offset of the glyph from the cursor, in pixels
+ * @yoff:	Y offset of the glyph from the baseline, in pixels
+ * @size:	Number of bytes allocated for this glyph
+ * @data:	Pixels, @height rows of @width pixels in the format of @bpix
+ */
+struct console_tt_glyph {
+	struct list_head sibling;
+	struct list_head lru;
+	const u8 *font_data;
+	int font_size;
+	int cp;
+	double x_shift;
+	enum video_log2_bpp bpix;
+	bool fg;
+	bool bg;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	uint size;
+	u8 data[] __aligned(sizeof(ulong));
+};
+
+/**
+ * struct console_tt_cache - Cache of rendered glyphs
+ *
+ * Rendering a glyph is much slower than drawing it, so glyphs are kept once
+ * rendered, up to CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE KB. When that is used up
+ * the least recently used glyphs are dropped. A glyph is always added, even if
+ * it is larger than the whole cache.
+ *
+ * @hash:	Hash chains of glyphs, see tt_glyph_hash()
+ * @lru:	List of all glyphs, most recently used first
+ * @size:	Total bytes allocated for glyphs
+ */
+struct console_tt_cache {
+	struct list_head hash[GLYPH_HASH_SIZE];
+	struct list_head lru;
+	ulong size;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -167,6 +230,7 @@ struct console_tt_metrics {
  *		last character. We record enough characters to go back to the
  *		start of the current command line.
  * @pos_ptr:	Current position in the position history
+ * @cache:	Cache of rendered glyphs, or NULL if none
  */
 struct console_tt_priv {
 	struct console_tt_metrics *cur_met;
@@ -174,6 +238,7 @@ struct console_tt_priv {
 	int num_metrics;
 	struct pos_info pos[POS_HISTORY_SIZE];
 	int pos_ptr;
+	struct console_tt_cache *cache;
 };
 
 /**
@@ -261,6 +326,224 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+STAT_COUNTER_DEFINE(video, glyph_hits);
+STAT_COUNTER_DEFINE(video, glyph_misses);
+
+static uint tt_glyph_hash(int font_size, int cp)
+{
+	return (cp * 31 + font_size) & (GLYPH_HASH_SIZE - 1);
+}
+
+static void tt_free_glyph(struct console_tt_cache *cache,
+			  struct console_tt_glyph *glyph)
+{
+	list_del(&glyph->sibling);
+	list_del(&glyph->lru);
+	cache->size -= glyph->size;
+	free(glyph);
+}
+
+/**
+ * tt_render_glyph() - Render a glyph in the format of the display
+ *
+ * The 8-bit-per-pixel image from the renderer is converted into the colour
+ * depth of the display. We only expect white-on-black or the reverse so the
+ * code only handles this simple case.
+ *
+ * @dev:	Device to render for
+ * @cp:		Code point to render
+ * @x_shift:	Fraction of a pixel to shift the glyph to the right
+ * @glyphp:	Returns the glyph, allocated with malloc()
+ * Return: 0 if OK, -ENOMEM if out of memory, -ENOSYS if the colour depth is
+ *	not supported
+ */
+static int tt_render_glyph(struct udevice *dev, int cp, double x_shift,
+			   struct console_tt_glyph **glyphp)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct console_tt_metrics *met = priv->cur_met;
+	struct console_tt_glyph *glyph;
+	int width, height, xoff, yoff;
+	u8 *bits, *data;
+	uint size;
+	int i;
+
+	switch (vid_priv->bpix) {
+	case VIDEO_BPP8:
+		if (IS_ENABLED(CONFIG_VIDEO_BPP8))
+			break;
+		return -ENOSYS;
+	case VIDEO_BPP16:
+		if (IS_ENABLED(CONFIG_VIDEO_BPP16))
+			break;
+		return -ENOSYS;
+	case VIDEO_BPP32:
+		if (IS_ENABLED(CONFIG_VIDEO_BPP32))
+			break;
+		return -ENOSYS;
+	default:
+		return -ENOSYS;
+	}
+
+	/*
+	 * Pass the offset into the render, which will return a
+	 * 8-bit-per-pixel image of the character. For empty characters, like
+	 * ' ', data will return NULL;
+	 */
+	data = stbtt_GetCodepointBitmapSubpixel(&met->font, met->scale,
+						met->scale, x_shift, 0, cp,
+						&width, &height, &xoff, &yoff);
+	if (!data)
+		width = height = 0;
+	size = sizeof(*glyph) + width * height * VNBYTES(vid_priv->bpix);
+	glyph = malloc(size);
+	if (!glyph) {
+		free(data);
+		return -ENOMEM;
+	}
+	glyph->font_data = met->font_data;
+	glyph->font_size = met->font_size;
+	glyph->cp = cp;
+	glyph->x_shift = x_shift;
+	glyph->bpix = vid_priv->bpix;
+	glyph->fg = vid_priv->colour_fg;
+	glyph->bg = vid_priv->colour_bg;
+	glyph->width = width;
+	glyph->height = height;
+	glyph->xoff = xoff;
+	glyph->yoff = yoff;
+	glyph->size = size;
+
+	bits = data;
+	for (i = 0; i < width * height; i++) {
+		int val = *bits++;
+
+		if (glyph->bg)
+			val = 255 - val;
+		switch (vid_priv->bpix) {
+		case VIDEO_BPP8:
+			glyph->data[i] = val;
+			break;
+		case VIDEO_BPP16:
+			((u16 *)glyph->data)[i] = val >> 3 |
+				(val >> 2) << 5 |
+				(val >> 3) << 11;
+			break;
+		default:
+			((u32 *)glyph->data)[i] = val | val << 8 | val << 16;
+			break;
+		}
+	}
+	free(data);
+	*glyphp = glyph;
+
+	return 0;
+}
+
+/**
+ * tt_get_glyph() - Get a glyph for the current font and display colours
+ *
+ * The glyph is taken from the cache if possible, otherwise it is rendered and
+ * added to the cache, dropping the least recently used glyphs to make room.
+ *
+ * @dev:	Device to use
+ * @cp:		Code point to get
+ * @x_shift:	Fraction of a pixel to shift the glyph to the right
+ * @glyphp:	Returns the glyph. If there is no cache this is allocated with
+ *		malloc() and must be freed by the caller
+ * Return: 0 if OK, -ve on error
+ */
+static int tt_get_glyph(struct udevice *dev, int cp, double x_shift,
+			struct console_tt_glyph **glyphp)
+{
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct console_tt_metrics *met = priv->cur_met;
+	struct console_tt_cache *cache = priv->cache;
+	const ulong limit = CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE * 1024UL;
+	struct console_tt_glyph *glyph;
+	struct list_head *head = NULL;
+	int ret;
+
+	if (cache) {
+		head = &cache->hash[tt_glyph_hash(met->font_size, cp)];
+		list_for_each_entry(glyph, head, sibling) {
+			if (glyph->cp == cp && glyph->x_shift == x_shift &&
+			    glyph->font_size == met->font_size &&
+			    glyph->font_data == met->font_data &&
+			    glyph->bpix == vid_priv->bpix &&
+			    glyph->fg == !!vid_priv->colour_fg &&
+			    glyph->bg == !!vid_priv->colour_bg) {
+				list_move(&glyph->lru, &cache->lru);
+				STAT_INC(video, glyph_hits);
+				*glyphp = glyph;
+				return 0;
+			}
+		}
+	}
+	STAT_INC(video, glyph_misses);
+
+	ret = tt_render_glyph(dev, cp, x_shift, &glyph);
+	if (ret)
+		return ret;
+	if (cache) {
+		while (cache->size + glyph->size > limit &&
+		       !list_empty(&cache->lru))
+			tt_free_glyph(cache, list_last_entry(&cache->lru,
+						struct console_tt_glyph, lru));
+		list_add(&glyph->sibling, head);
+		list_add(&glyph->lru, &cache->lru);
+		cache->size += glyph->size;
+	}
+	*glyphp = glyph;
+
+	return 0;
+}
+
+/**
+ * tt_blit_row() - Draw a row of a glyph into the frame buffer
+ *
+ * Since the display only shows white-on-black or the reverse, drawing is a
+ * bitwise operation on each byte. This uses whole words where the source and
+ * destination are aligned the same way.
+ *
+ * @dst:	Frame buffer to draw into
+ * @src:	Glyph pixels in the format of the display
+ * @len:	Number of bytes to draw
+ * @set:	true to OR the pixels into the frame buffer, false to AND them
+ */
+static void tt_blit_row(u8 *dst, const u8 *src, uint len, bool set)
+{
+	const ulong mask = sizeof(ulong) - 1;
+
+	if (!(((ulong)dst ^ (ulong)src) & mask)) {
+		for (; len && ((ulong)dst & mask); len--, dst++, src++)
+			*dst = set ? *dst | *src : *dst & *src;
+		for (; len >= sizeof(ulong); len -= sizeof(ulong)) {
+			ulong *d = (ulong *)dst;
+			ulong val = *(const ulong *)src;
+
+			*d = set ? *d | val : *d & val;
+			dst += sizeof(ulong);
+			src += sizeof(ulong);
+		}
+	} else if (!(((ulong)dst ^ (ulong)src) & 3)) {
+		for (; len && ((ulong)dst & 3); len--, dst++, src++)
+			*dst = set ? *dst | *src : *dst & *src;
+		for (; len >= sizeof(u32); len -= sizeof(u32)) {
+			u32 *d = (u32 *)dst;
+			u32 val = *(const u32 *)src;
+
+			*d = set ? *d | val : *d & val;
+			dst += sizeof(u32);
+			src += sizeof(u32);
+		}
+	}
+	for (; len; len--, dst++, src++)
+		*dst = set ? *dst | *src : *dst & *src;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    int cp)
 {
@@ -270,15 +553,15 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
 	stbtt_fontinfo *font = &met->font;
-	int width, height, xoff, yoff;
+	struct console_tt_glyph *glyph;
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
+	const u8 *bits;
 	int advance;
-	void *start, *end, *line;
-	int row, ret;
+	void *start, *line;
+	int row, pbytes, ret = 0;
 
 	/* First get some basic metrics about this character */
 	stbtt_GetCodepointHMetrics(font, cp, &advance, &lsb);
@@ -314,111 +597,38 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	}
 
 	/*
-	 * Figure out how much past the start of a pixel we are, and pass this
-	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * Figure out how much past the start of a pixel we are and find the
+	 * character rendered with that offset, in the format of the display
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, met->scale, met->scale,
-						x_shift, 0, cp, &width, &height,
-						&xoff, &yoff);
-	if (!data)
-		return width_frac;
+	ret = tt_get_glyph(dev, cp, x_shift, &glyph);
+	if (ret)
+		return ret;
+	if (!glyph->height)
+		goto done;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
+	pbytes = VNBYTES(vid_priv->bpix);
 	start = vid_priv->fb + y * vid_priv->line_length +
-		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = met->baseline + yoff;
+		VID_TO_PIXEL(x) * pbytes;
+	linenum = met->baseline + glyph->yoff;
 	if (linenum > 0)
 		start += linenum * vid_priv->line_length;
 	line = start;
 
-	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
-	 */
-	for (row = 0; row < height; row++) {
-		switch (vid_priv->bpix) {
-		case VIDEO_BPP8:
-			if (IS_ENABLED(CONFIG_VIDEO_BPP8)) {
-				u8 *dst = line + xoff;
-				int i;
-
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val >> 3 |
-						(val >> 2) << 5 |
-						(val >> 3) << 11;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
-			int i;
-
-			if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-				for (i = 0; i < width; i++) {
-					int val = *bits;
-					int out;
-
-					if (vid_priv->colour_bg)
-						val = 255 - val;
-					out = val | val << 8 | val << 16;
-					if (vid_priv->colour_fg)
-						*dst++ |= out;
-					else
-						*dst++ &= out;
-					bits++;
-				}
-				end = dst;
-			}
-			break;
-		}
-		default:
-			free(data);
-			return -ENOSYS;
-		}
-
+	/* Write a row at a time, a word at a time where possible */
+	bits = glyph->data;
+	for (row = 0; row < glyph->height; row++) {
+		tt_blit_row(line + glyph->xoff * pbytes, bits,
+			    glyph->width * pbytes, glyph->fg);
+		bits += glyph->width * pbytes;
 		line += vid_priv->line_length;
 	}
 	ret = vidconsole_sync_copy(dev, start, line);
+done:
+	if (!priv->cache)
+		free(glyph);
 	if (ret)
 		return ret;
-	free(data);
 
 	return width_frac;
 }
@@ -970,11 +1180,40 @@ static int console_truetype_probe(struct udevice *dev)
 
 	select_metrics(dev, &priv->metrics[ret]);
 
+	/* Run without a cache if there is no memory for one */
+	if (CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE) {
+		priv->cache = malloc(sizeof(*priv->cache));
+		if (priv->cache) {
+			int i;
+
+			for (i = 0; i < GLYPH_HASH_SIZE; i++)
+				INIT_LIST_HEAD(&priv->cache->hash[i]);
+			INIT_LIST_HEAD(&priv->cache->lru);
+			priv->cache->size = 0;
+		}
+	}
+
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	struct console_tt_cache *cache = priv->cache;
+	struct console_tt_glyph *glyph, *next;
+
+	if (cache) {
+		list_for_each_entry_safe(glyph, next, &cache->lru, lru)
+			tt_free_glyph(cache, glyph);
+		free(cache);
+		priv->cache = NULL;
+	}
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -996,5 +1235,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto	= sizeof(struct console_tt_priv),
 };
@@ -38,6 +38,7 @@ struct eswin_crtc_funcs {
 	int (*unprepare)(struct display_state *state);
 	int (*fixup_dts)(struct display_state *state, void *blob);
 	int (*send_mcu_cmd)(struct display_state *state, u32 type, u32 value);
+	int (*set_address)(struct display_state *state, u32 addr);
 };
 
 struct dc8000_data;
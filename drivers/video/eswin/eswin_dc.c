@@ -449,6 +449,22 @@ static gctINT eswin_dc_fixup_dts(struct display_state *state, void *blob)
 	return 0;
 }
 
+static gctINT eswin_dc_set_address(struct display_state *state, gctUINT32 addr)
+{
+	struct crtc_state *crtc_state = &state->crtc_state;
+	struct dc8000_dc *dc = crtc_state->private;
+
+	if (state->layer == ESWIN_OVERLAY_LAYER) {
+		dc->overlay_ctrl.dcOverlayAddr0 = addr;
+		eswin_hw_set_overlay_address(dc, addr);
+	} else {
+		dc->fb_ctrl.dcFBAddr0 = addr;
+		eswin_hw_set_framebuffer_address(dc, addr);
+	}
+
+	return 0;
+}
+
 static gctINT eswin_dc_send_mcu_cmd(struct display_state *state,
 				     gctUINT32 type, gctUINT32 value)
 {
@@ -484,4 +500,5 @@ const struct eswin_crtc_funcs eswin_dc_funcs = {
 	.disable = eswin_dc_disable,
 	.fixup_dts = eswin_dc_fixup_dts,
 	.send_mcu_cmd = eswin_dc_send_mcu_cmd,
+	.set_address = eswin_dc_set_address,
 };
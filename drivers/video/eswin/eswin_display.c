@@ -117,9 +117,10 @@ static int argb8888_to_rgb565(unsigned char *argb8888, unsigned short *rgb565, u
     return 0;
 }
 
-static void init_display_buffer(ulong base)
+/* The memory pool follows the frame buffer at the end of plat->size */
+static void init_display_buffer(ulong base, ulong size)
 {
-	memory_start = base + DRM_ESWIN_FB_SIZE;
+	memory_start = base + size - MEMORY_POOL_SIZE;
 	memory_end = memory_start;
 }
 
@@ -1302,7 +1303,7 @@ static int eswin_display_probe(struct udevice *dev)
 	}
 	data->phy_init = false;
 
-	init_display_buffer(plat->base);
+	init_display_buffer(plat->base, plat->size);
 #ifdef CONFIG_ESWIN_LOGO_DISPLAY
 	logo_buf = (unsigned char *)get_display_buffer(DRM_ESWIN_FB_SIZE);
 	if(logo_buf != NULL) {
@@ -1453,6 +1454,9 @@ static int eswin_display_probe(struct udevice *dev)
 	uc_priv->bpix = DRM_ESWIN_FB_BPP;
 #ifndef CONFIG_ESWIN_LOGO_DISPLAY
 	uc_priv->fb = (void *)plat->base;
+	if (IS_ENABLED(CONFIG_VIDEO_PAN) &&
+	    s->crtc_state.crtc->funcs->set_address)
+		uc_priv->pan_size = plat->size - MEMORY_POOL_SIZE;
 #endif
 
 	s->logo.mode = ESWIN_DISPLAY_FULLSCREEN;
@@ -1474,23 +1478,49 @@ int eswin_display_bind(struct udevice *dev)
 {
 	struct video_uc_plat *plat = dev_get_uclass_plat(dev);
 
+	/* Reserve a second screen to pan through */
 	plat->size = DRM_ESWIN_FB_SIZE + MEMORY_POOL_SIZE;
+	if (IS_ENABLED(CONFIG_VIDEO_PAN))
+		plat->size += DRM_ESWIN_FB_SIZE;
 
 	return 0;
 }
 
 #ifndef CONFIG_ESWIN_LOGO_DISPLAY
 static int eswin_display_sync(struct udevice *dev)
+{
+	ulong start, end;
+
+	/* Only flush what was drawn since the last sync */
+	if (video_get_damage(dev, &start, &end))
+		sifive_l3_flush64_range(start, end - start);
+
+	return 0;
+}
+
+static int eswin_display_set_start(struct udevice *dev, ulong offset)
 {
 	struct video_uc_plat *plat = dev_get_uclass_plat(dev);
+	struct display_state *s;
+	const struct eswin_crtc_funcs *crtc_funcs;
+	int ret;
 
-	sifive_l3_flush64_range((unsigned long)plat->base, DRM_ESWIN_FB_SIZE);
+	list_for_each_entry(s, &eswin_display_list, head) {
+		crtc_funcs = s->crtc_state.crtc->funcs;
+		if (!crtc_funcs->set_address)
+			return -ENOSYS;
+		s->crtc_state.dma_addr = (u32)(plat->base + offset);
+		ret = crtc_funcs->set_address(s, s->crtc_state.dma_addr);
+		if (ret)
+			return ret;
+	}
 
 	return 0;
 }
 
 static const struct video_ops eswin_display_ops = {
 	.video_sync = eswin_display_sync,
+	.set_start = eswin_display_set_start,
 };
 #endif
 
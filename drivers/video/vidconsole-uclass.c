@@ -96,10 +96,16 @@ static void vidconsole_newline(struct udevice *dev)
 
 	/* Check if we need to scroll the terminal */
 	if ((priv->ycur + priv->y_charsize) / priv->y_charsize > priv->rows) {
-		vidconsole_move_rows(dev, 0, rows, priv->rows - rows);
-		for (i = 0; i < rows; i++)
-			vidconsole_set_row(dev, priv->rows - i - 1,
-					   vid_priv->colour_bg);
+		/*
+		 * Pan the display if possible, to avoid moving everything.
+		 * Panning clears the new rows itself.
+		 */
+		if (video_pan_up(vid_dev, rows * priv->y_charsize)) {
+			vidconsole_move_rows(dev, 0, rows, priv->rows - rows);
+			for (i = 0; i < rows; i++)
+				vidconsole_set_row(dev, priv->rows - i - 1,
+						   vid_priv->colour_bg);
+		}
 		priv->ycur -= rows * priv->y_charsize;
 	}
 	priv->last_ch = 0;
@@ -765,7 +771,7 @@ UCLASS_DRIVER(vidconsole) = {
 	.per_device_auto	= sizeof(struct vidconsole_priv),
 };
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 int vidconsole_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct udevice *vid = dev_get_parent(dev);
@@ -351,10 +351,44 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = video_index_to_colour(priv, back);
 }
 
+void video_damage(struct udevice *dev, void *start, void *end)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE) || start >= end)
+		return;
+
+	if (!priv->damage_end) {
+		priv->damage_start = start;
+		priv->damage_end = end;
+	} else {
+		priv->damage_start = min(priv->damage_start, start);
+		priv->damage_end = max(priv->damage_end, end);
+	}
+}
+
+bool video_get_damage(struct udevice *dev, ulong *startp, ulong *endp)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		*startp = (ulong)priv->fb;
+		*endp = (ulong)priv->fb + priv->fb_size;
+		return true;
+	}
+	if (!priv->damage_end)
+		return false;
+	*startp = (ulong)priv->damage_start;
+	*endp = (ulong)priv->damage_end;
+
+	return true;
+}
+
 /* Flush video activity to the caches */
 int video_sync(struct udevice *vid, bool force)
 {
 	struct video_ops *ops = video_get_ops(vid);
+	struct video_priv *priv = dev_get_uclass_priv(vid);
 	int ret;
 
 	if (ops && ops->video_sync) {
@@ -369,15 +403,13 @@ int video_sync(struct udevice *vid, bool force)
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
+	ulong start, end;
 
-	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
+	if (priv->flush_dcache && video_get_damage(vid, &start, &end)) {
+		flush_dcache_range(ALIGN_DOWN(start, CONFIG_SYS_CACHELINE_SIZE),
+				   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
 	}
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
 	if (force || get_timer(last_sync) > 100) {
@@ -385,6 +417,18 @@ int video_sync(struct udevice *vid, bool force)
 		last_sync = get_timer(0);
 	}
 #endif
+	priv->damage_end = NULL;
+
+	/* Only move the display once the new part is in memory */
+	if (priv->pan_pending) {
+		struct video_uc_plat *plat = dev_get_uclass_plat(vid);
+
+		ret = ops->set_start(vid, map_to_sysmem(priv->fb) - plat->base);
+		if (ret)
+			return ret;
+		priv->pan_pending = false;
+	}
+
 	return 0;
 }
 
@@ -397,6 +441,9 @@ void video_sync_all(void)
 	     dev;
 	     uclass_find_next_device(&dev)) {
 		if (device_active(dev)) {
+			struct video_priv *priv = dev_get_uclass_priv(dev);
+
+			video_damage(dev, priv->fb, priv->fb + priv->fb_size);
 			ret = video_sync(dev, true);
 			if (ret)
 				dev_dbg(dev, "Video sync failed\n");
@@ -404,6 +451,57 @@ void video_sync_all(void)
 	}
 }
 
+int video_pan_up(struct udevice *dev, int lines)
+{
+	struct video_uc_plat *plat = dev_get_uclass_plat(dev);
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	ulong bytes = lines * priv->line_length;
+	ulong offset;
+	void *base;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_PAN) || !ops || !ops->set_start ||
+	    priv->pan_size <= priv->fb_size || priv->rot || priv->copy_fb)
+		return -ENOSYS;
+	if (lines >= priv->ysize)
+		return -E2BIG;
+
+	base = map_sysmem(plat->base, priv->pan_size);
+	offset = priv->fb - base + bytes;
+	if (offset + priv->fb_size > priv->pan_size) {
+		/* Out of room, so move what stays visible back to the start */
+		memmove(base, priv->fb + bytes, priv->fb_size - bytes);
+		video_damage(dev, base, base + priv->fb_size - bytes);
+		offset = 0;
+	}
+	priv->fb = base + offset;
+	priv->pan_pending = true;
+
+	return video_fill_part(dev, 0, priv->ysize - lines, priv->xsize,
+			       priv->ysize, priv->colour_bg);
+}
+
+int video_pan_stop(struct udevice *dev)
+{
+	struct video_uc_plat *plat = dev_get_uclass_plat(dev);
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	void *base;
+
+	if (!priv->pan_size)
+		return 0;
+	priv->pan_size = 0;
+
+	base = map_sysmem(plat->base, priv->fb_size);
+	if (priv->fb == base)
+		return 0;
+	memmove(base, priv->fb, priv->fb_size);
+	priv->fb = base;
+	priv->pan_pending = true;
+	video_damage(dev, base, base + priv->fb_size);
+
+	return video_sync(dev, true);
+}
+
 bool video_is_active(void)
 {
 	struct udevice *dev;
@@ -432,54 +530,56 @@ int video_get_ysize(struct udevice *dev)
 	return priv->ysize;
 }
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
+	long offset, size;
 
-	if (priv->copy_fb) {
-		long offset, size;
+	if (!priv->copy_fb && !IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		return 0;
 
-		/* Find the offset of the first byte to copy */
-		if ((ulong)to > (ulong)from) {
-			size = to - from;
-			offset = from - priv->fb;
-		} else {
-			size = from - to;
-			offset = to - priv->fb;
-		}
+	/* Find the offset of the first byte to copy */
+	if ((ulong)to > (ulong)from) {
+		size = to - from;
+		offset = from - priv->fb;
+	} else {
+		size = from - to;
+		offset = to - priv->fb;
+	}
 
-		/*
-		 * Allow a bit of leeway for valid requests somewhere near the
-		 * frame buffer
-		 */
-		if (offset < -priv->fb_size || offset > 2 * priv->fb_size) {
+	/*
+	 * Allow a bit of leeway for valid requests somewhere near the
+	 * frame buffer
+	 */
+	if (offset < -priv->fb_size || offset > 2 * priv->fb_size) {
 #ifdef DEBUG
-			char str[120];
+		char str[120];
 
-			snprintf(str, sizeof(str),
-				 "[** FAULT sync_copy fb=%p, from=%p, to=%p, offset=%lx]",
-				 priv->fb, from, to, offset);
-			console_puts_select_stderr(true, str);
+		snprintf(str, sizeof(str),
+			 "[** FAULT sync_copy fb=%p, from=%p, to=%p, offset=%lx]",
+			 priv->fb, from, to, offset);
+		console_puts_select_stderr(true, str);
 #endif
-			return -EFAULT;
-		}
+		return -EFAULT;
+	}
 
-		/*
-		 * Silently crop the memcpy. This allows callers to avoid doing
-		 * this themselves. It is common for the end pointer to go a
-		 * few lines after the end of the frame buffer, since most of
-		 * the update algorithms terminate a line after their last write
-		 */
-		if (offset + size > priv->fb_size) {
-			size = priv->fb_size - offset;
-		} else if (offset < 0) {
-			size += offset;
-			offset = 0;
-		}
+	/*
+	 * Silently crop the memcpy. This allows callers to avoid doing
+	 * this themselves. It is common for the end pointer to go a
+	 * few lines after the end of the frame buffer, since most of
+	 * the update algorithms terminate a line after their last write
+	 */
+	if (offset + size > priv->fb_size) {
+		size = priv->fb_size - offset;
+	} else if (offset < 0) {
+		size += offset;
+		offset = 0;
+	}
 
+	video_damage(dev, priv->fb + offset, priv->fb + offset + size);
+	if (priv->copy_fb)
 		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
-	}
 
 	return 0;
 }
@@ -642,12 +742,19 @@ static int video_post_bind(struct udevice *dev)
 	return 0;
 }
 
+/* Leave the display showing the start of the frame buffer */
+static int video_pre_remove(struct udevice *dev)
+{
+	return video_pan_stop(dev);
+}
+
 UCLASS_DRIVER(video) = {
 	.id		= UCLASS_VIDEO,
 	.name		= "video",
 	.flags		= DM_UC_FLAG_SEQ_ALIAS,
 	.post_bind	= video_post_bind,
 	.post_probe	= video_post_probe,
+	.pre_remove	= video_pre_remove,
 	.priv_auto	= sizeof(struct video_uc_priv),
 	.per_device_auto	= sizeof(struct video_priv),
 	.per_device_plat_auto	= sizeof(struct video_uc_plat),
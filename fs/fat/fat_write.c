@@ -435,6 +435,175 @@ fill_dir_slot(fat_itr *itr, const char *l_name, const char *shortname)
 	return 0;
 }
 
+/*
+ * Record in the free-cluster map whether cluster 'clust' is in use
+ */
+static void free_map_mark(fsdata *mydata, __u32 clust, bool used)
+{
+	ulong *word = &mydata->free_map[BIT_WORD(clust)];
+	ulong mask = BIT_MASK(clust);
+
+	if (used && !(*word & mask)) {
+		*word |= mask;
+		mydata->free_clusts--;
+	} else if (!used && (*word & mask)) {
+		*word &= ~mask;
+		mydata->free_clusts++;
+	}
+}
+
+/**
+ * free_map_init() - build the free-cluster map
+ *
+ * Read the whole FAT once and record which clusters are in use, so that
+ * allocations do not have to search the FAT on disk.
+ *
+ * @mydata:	filesystem parameters
+ * Return:	0 on success, -ENOMEM if out of memory
+ */
+static int free_map_init(fsdata *mydata)
+{
+	u32 data_clusts, fat_entries, max_clust, clust;
+
+	data_clusts = (mydata->total_sect - mydata->data_begin) /
+		      mydata->clust_size;
+	fat_entries = min_t(u64, (u64)mydata->fatlength * mydata->sect_size *
+			    8 / mydata->fatsize, U32_MAX);
+	max_clust = mydata->fatsize == 32 ? 0xffffff0 :
+		    mydata->fatsize == 16 ? 0xfff0 : 0xff0;
+	max_clust = min3(data_clusts, fat_entries, max_clust);
+
+	mydata->free_map = calloc(BITS_TO_LONGS(max_clust), sizeof(ulong));
+	if (!mydata->free_map)
+		return -ENOMEM;
+	mydata->max_clust = max_clust;
+	mydata->free_clusts = BITS_TO_LONGS(max_clust) * BITS_PER_LONG;
+	mydata->next_free = 2;
+
+	/* Entries 0 and 1 and the padding at the end are never free */
+	free_map_mark(mydata, 0, true);
+	free_map_mark(mydata, 1, true);
+	for (clust = max_clust; clust % BITS_PER_LONG; clust++)
+		free_map_mark(mydata, clust, true);
+
+	for (clust = 2; clust < max_clust; clust++) {
+		if (get_fatent(mydata, clust))
+			free_map_mark(mydata, clust, true);
+	}
+	debug("FAT%d: %u of %u clusters free\n", mydata->fatsize,
+	      mydata->free_clusts, max_clust - 2);
+
+	return 0;
+}
+
+/*
+ * Return the first free cluster in ['clust', 'end'), or 'end' if there is
+ * none
+ */
+static __u32 free_map_next(fsdata *mydata, __u32 clust, __u32 end)
+{
+	const ulong *map = mydata->free_map;
+
+	while (clust < end) {
+		if (!(clust % BITS_PER_LONG) && map[BIT_WORD(clust)] == ~0UL) {
+			clust += BITS_PER_LONG;
+			continue;
+		}
+		if (!(map[BIT_WORD(clust)] & BIT_MASK(clust)))
+			return clust;
+		clust++;
+	}
+
+	return end;
+}
+
+/*
+ * Return the number of free clusters starting at 'clust', up to 'max'
+ */
+static __u32 free_map_run(fsdata *mydata, __u32 clust, __u32 max)
+{
+	__u32 len = 0;
+
+	while (len < max &&
+	       !(mydata->free_map[BIT_WORD(clust + len)] &
+		 BIT_MASK(clust + len)))
+		len++;
+
+	return len;
+}
+
+/*
+ * Look for a run of 'count' free clusters in ['start', 'end'). Return true
+ * if one is found. Either way *bestp and *best_lenp are updated with the
+ * longest run seen so far.
+ */
+static bool free_map_scan(fsdata *mydata, __u32 start, __u32 end,
+			  __u32 count, __u32 *bestp, __u32 *best_lenp)
+{
+	__u32 clust = start, len;
+
+	while ((clust = free_map_next(mydata, clust, end)) < end) {
+		len = free_map_run(mydata, clust, min(end - clust, count));
+		if (len > *best_lenp) {
+			*bestp = clust;
+			*best_lenp = len;
+			if (len == count)
+				return true;
+		}
+		clust += len;
+	}
+
+	return false;
+}
+
+/**
+ * find_free_run() - allocate a run of consecutive free clusters
+ *
+ * A run that continues straight on from @prev is preferred, so that a file
+ * grows in place. Otherwise this is a next-fit search for the first run of
+ * @count clusters, falling back to the longest run there is. The clusters
+ * returned are marked as in use in the free-cluster map, but their FAT
+ * entries are left for the caller to fill in.
+ *
+ * @mydata:	filesystem parameters
+ * @prev:	cluster the run is to follow, or 0 if none
+ * @count:	number of clusters wanted
+ * @lenp:	returns the number of clusters allocated, 1 to @count
+ * Return:	first cluster of the run, or 0 if the filesystem is full
+ */
+static __u32 find_free_run(fsdata *mydata, __u32 prev, __u32 count,
+			   __u32 *lenp)
+{
+	__u32 best = 0, best_len = 0, i;
+
+	if (!mydata->free_map && free_map_init(mydata))
+		return 0;
+	if (!mydata->free_clusts || !count)
+		return 0;
+
+	if (prev && prev + 1 < mydata->max_clust)
+		best_len = free_map_run(mydata, prev + 1,
+					min(mydata->max_clust - prev - 1,
+					    count));
+	if (best_len)
+		best = prev + 1;
+	else if (!free_map_scan(mydata, mydata->next_free, mydata->max_clust,
+				count, &best, &best_len))
+		free_map_scan(mydata, 2, mydata->next_free, count, &best,
+			      &best_len);
+
+	for (i = 0; i < best_len; i++)
+		free_map_mark(mydata, best + i, true);
+	mydata->next_free = best + best_len;
+	if (mydata->next_free >= mydata->max_clust)
+		mydata->next_free = 2;
+	*lenp = best_len;
+	debug("FAT%d: allocated %u clusters at %08x\n", mydata->fatsize,
+	      best_len, best);
+
+	return best;
+}
+
 /*
  * Set the entry at index 'entry' in a FAT (12/16/32) table.
  */
@@ -487,6 +656,9 @@ static int set_fatent_value(fsdata *mydata, __u32 entry, __u32 entry_value)
 	/* Mark as dirty */
 	mydata->fat_dirty = 1;
 
+	if (mydata->free_map && entry < mydata->max_clust)
+		free_map_mark(mydata, entry, entry_value != 0);
+
 	/* Set the actual entry */
 	switch (mydata->fatsize) {
 	case 32:
@@ -541,29 +713,6 @@ static int set_fatent_value(fsdata *mydata, __u32 entry, __u32 entry_value)
 	return 0;
 }
 
-/*
- * Determine the next free cluster after 'entry' in a FAT (12/16/32) table
- * and link it to 'entry'. EOC marker is not set on returned entry.
- */
-static __u32 determine_fatent(fsdata *mydata, __u32 entry)
-{
-	__u32 next_fat, next_entry = entry + 1;
-
-	while (1) {
-		next_fat = get_fatent(mydata, next_entry);
-		if (next_fat == 0) {
-			/* found free entry, link to entry */
-			set_fatent_value(mydata, entry, next_entry);
-			break;
-		}
-		next_entry++;
-	}
-	debug("FAT%d: entry: %08x, entry_value: %04x\n",
-	       mydata->fatsize, entry, next_entry);
-
-	return next_entry;
-}
-
 /**
  * set_sectors() - write data to sectors
  *
@@ -636,7 +785,7 @@ set_sectors(fsdata *mydata, u32 startsect, u8 *buffer, u32 size)
  * @mydata:	data to be written
  * @clustnum:	cluster to be written to
  * @buffer:	data to be written
- * @size:	bytes to be written (but not more than the size of a cluster)
+ * @size:	bytes to be written, may run on into the following clusters
  * Return:	0 on success, -1 otherwise
  */
 static int
@@ -800,27 +949,20 @@ get_set_cluster(fsdata *mydata, __u32 clustnum, loff_t pos, __u8 *buffer,
 }
 
 /*
- * Find the first empty cluster
+ * Find an empty cluster, or return 0 if there is none
  */
-static int find_empty_cluster(fsdata *mydata)
+static __u32 find_empty_cluster(fsdata *mydata)
 {
-	__u32 fat_val, entry = 3;
-
-	while (1) {
-		fat_val = get_fatent(mydata, entry);
-		if (fat_val == 0)
-			break;
-		entry++;
-	}
+	__u32 len;
 
-	return entry;
+	return find_free_run(mydata, 0, 1, &len);
 }
 
 /**
  * new_dir_table() - allocate a cluster for additional directory entries
  *
  * @itr:	directory iterator
- * Return:	0 on success, -EIO otherwise
+ * Return:	0 on success, -ENOSPC if the filesystem is full, -EIO otherwise
  */
 static int new_dir_table(fat_itr *itr)
 {
@@ -830,6 +972,8 @@ static int new_dir_table(fat_itr *itr)
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
 
 	dir_newclust = find_empty_cluster(mydata);
+	if (!dir_newclust)
+		return -ENOSPC;
 
 	/*
 	 * Flush before updating FAT to ensure valid directory structure
@@ -895,30 +1039,6 @@ static void set_start_cluster(const fsdata *mydata, dir_entry *dentptr,
 	dentptr->start = cpu_to_le16(start_cluster & 0xffff);
 }
 
-/*
- * Check whether adding a file makes the file system to
- * exceed the size of the block device
- * Return -1 when overflow occurs, otherwise return 0
- */
-static int check_overflow(fsdata *mydata, __u32 clustnum, loff_t size)
-{
-	__u32 startsect, sect_num, offset;
-
-	if (clustnum > 0)
-		startsect = clust_to_sect(mydata, clustnum);
-	else
-		startsect = mydata->rootdir_sect;
-
-	sect_num = div_u64_rem(size, mydata->sect_size, &offset);
-
-	if (offset != 0)
-		sect_num++;
-
-	if (startsect + sect_num > total_sector)
-		return -1;
-	return 0;
-}
-
 /*
  * Write at most 'maxsize' bytes from 'buffer' into
  * the file associated with 'dentptr'
@@ -931,7 +1051,7 @@ set_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos, __u8 *buffer,
 {
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
 	__u32 curclust = START(dentptr);
-	__u32 endclust = 0, newclust = 0;
+	__u32 endclust = 0, newclust = 0, count, len;
 	u64 cur_pos, filesize;
 	loff_t offset, actsize, wsize;
 
@@ -1070,83 +1190,59 @@ set_clusters:
 	assert(!pos);
 
 	/* Assure that curclust is valid */
-	if (!curclust) {
-		curclust = find_empty_cluster(mydata);
-		set_start_cluster(mydata, dentptr, curclust);
-	} else {
+	if (curclust) {
 		newclust = get_fatent(mydata, curclust);
-
-		if (IS_LAST_CLUST(newclust, mydata->fatsize)) {
-			newclust = determine_fatent(mydata, curclust);
-			set_fatent_value(mydata, curclust, newclust);
-			curclust = newclust;
-		} else {
+		if (!IS_LAST_CLUST(newclust, mydata->fatsize)) {
 			debug("error: something wrong\n");
 			return -1;
 		}
 	}
 
-	/* TODO: already partially written */
-	if (check_overflow(mydata, curclust, filesize)) {
+	if (!mydata->free_map && free_map_init(mydata)) {
+		printf("Error: out of memory\n");
+		return -1;
+	}
+	count = div_u64(filesize + bytesperclust - 1, bytesperclust);
+	if (count > mydata->free_clusts) {
 		printf("Error: no space left: %llu\n", filesize);
 		return -1;
 	}
 
-	actsize = bytesperclust;
-	endclust = curclust;
-	do {
-		/* search for consecutive clusters */
-		while (actsize < filesize) {
-			newclust = determine_fatent(mydata, endclust);
-
-			if ((newclust - 1) != endclust)
-				/* write to <curclust..endclust> */
-				goto getit;
-
-			if (CHECK_CLUST(newclust, mydata->fatsize)) {
-				debug("newclust: 0x%x\n", newclust);
-				debug("Invalid FAT entry\n");
-				return 0;
-			}
-			endclust = newclust;
-			actsize += bytesperclust;
-		}
-
-		/* set remaining bytes */
-		actsize = filesize;
-		if (set_cluster(mydata, curclust, buffer, (u32)actsize) != 0) {
-			debug("error: writing cluster\n");
+	/* write each run of consecutive clusters in one go */
+	while (count) {
+		newclust = find_free_run(mydata, curclust, count, &len);
+		if (!newclust) {
+			printf("Error: no space left: %llu\n", filesize);
 			return -1;
 		}
-		*gotsize += actsize;
-
-		/* Mark end of file in FAT */
-		if (mydata->fatsize == 12)
-			newclust = 0xfff;
-		else if (mydata->fatsize == 16)
-			newclust = 0xffff;
-		else if (mydata->fatsize == 32)
-			newclust = 0xfffffff;
-		set_fatent_value(mydata, endclust, newclust);
+		if (curclust)
+			set_fatent_value(mydata, curclust, newclust);
+		else
+			set_start_cluster(mydata, dentptr, newclust);
+		for (endclust = newclust; endclust < newclust + len - 1;
+		     endclust++)
+			set_fatent_value(mydata, endclust, endclust + 1);
 
-		return 0;
-getit:
-		if (set_cluster(mydata, curclust, buffer, (u32)actsize) != 0) {
+		actsize = min_t(u64, (u64)len * bytesperclust, filesize);
+		if (set_cluster(mydata, newclust, buffer, (u32)actsize) != 0) {
 			debug("error: writing cluster\n");
 			return -1;
 		}
 		*gotsize += actsize;
 		filesize -= actsize;
 		buffer += actsize;
+		count -= len;
+		curclust = endclust;
+	}
 
-		if (CHECK_CLUST(newclust, mydata->fatsize)) {
-			debug("newclust: 0x%x\n", newclust);
-			debug("Invalid FAT entry\n");
-			return 0;
-		}
-		actsize = bytesperclust;
-		curclust = endclust = newclust;
-	} while (1);
+	/* Mark end of file in FAT */
+	if (mydata->fatsize == 12)
+		newclust = 0xfff;
+	else if (mydata->fatsize == 16)
+		newclust = 0xffff;
+	else if (mydata->fatsize == 32)
+		newclust = 0xfffffff;
+	set_fatent_value(mydata, curclust, newclust);
 
 	return 0;
 }
@@ -1432,6 +1528,7 @@ int file_fat_write_at(const char *filename, loff_t pos, void *buffer,
 exit:
 	free(filename_copy);
 	free(mydata->fatbuf);
+	free(mydata->free_map);
 	free(itr);
 	return ret;
 }
@@ -1468,6 +1565,8 @@ static int fat_dir_entries(fat_itr *itr)
 		goto exit;
 	}
 	fsdata.fatbufnum = -1;
+	/* the free-cluster map belongs to the original */
+	fsdata.free_map = NULL;
 	dirs->fsdata = &fsdata;
 
 	for (count = 0; fat_itr_next(dirs); count++)
@@ -1622,6 +1721,7 @@ int fat_unlink(const char *filename)
 
 exit:
 	free(fsdata.fatbuf);
+	free(fsdata.free_map);
 	free(itr);
 	free(filename_copy);
 
@@ -1766,6 +1866,7 @@ int fat_mkdir(const char *dirname)
 exit:
 	free(dirname_copy);
 	free(mydata->fatbuf);
+	free(mydata->free_map);
 	free(itr);
 	free(dotdent);
 	return ret;
@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Arena allocator with checkpoints
+ *
+ * An arena hands out memory from large blocks obtained with malloc(). Objects
+ * are never freed one at a time. Instead arena_mark() records a checkpoint and
+ * arena_release() frees everything allocated since, in one go. This suits a
+ * phase of work which builds many small objects and then throws them all away,
+ * and keeps those objects from fragmenting the heap.
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <linux/types.h>
+
+struct arena_block;
+
+/**
+ * struct arena - An arena
+ *
+ * @block: Block currently being allocated from, or NULL if none
+ * @ptr: Next free byte in @block
+ * @end: End of @block
+ * @block_size: Size of each block; larger allocations get a block of their own
+ */
+struct arena {
+	struct arena_block *block;
+	char *ptr;
+	char *end;
+	ulong block_size;
+};
+
+/**
+ * struct arena_mark - A checkpoint in an arena, see arena_mark()
+ *
+ * @block: Block in use when the checkpoint was taken
+ * @ptr: Next free byte in @block at that time
+ */
+struct arena_mark {
+	struct arena_block *block;
+	char *ptr;
+};
+
+/**
+ * arena_init() - Set up an arena
+ *
+ * No memory is allocated until the first call to arena_alloc().
+ *
+ * @arena: Arena to set up
+ * @block_size: Size of each block to malloc(), in bytes
+ */
+void arena_init(struct arena *arena, ulong block_size);
+
+/**
+ * arena_alloc() - Allocate memory from an arena
+ *
+ * The memory is aligned to 16 bytes and is not cleared. It stays valid until
+ * arena_release() is called with a checkpoint taken before this call, or until
+ * arena_uninit().
+ *
+ * @arena: Arena to allocate from
+ * @size: Number of bytes to allocate
+ * Return: pointer to the memory, or NULL if out of memory
+ */
+void *arena_alloc(struct arena *arena, ulong size);
+
+/**
+ * arena_mark() - Take a checkpoint
+ *
+ * @arena: Arena to use
+ * @mark: Returns the checkpoint
+ */
+void arena_mark(struct arena *arena, struct arena_mark *mark);
+
+/**
+ * arena_release() - Free everything allocated since a checkpoint
+ *
+ * Checkpoints taken after @mark become invalid; @mark itself can be used
+ * again.
+ *
+ * @arena: Arena to use
+ * @mark: Checkpoint from arena_mark()
+ */
+void arena_release(struct arena *arena, const struct arena_mark *mark);
+
+/**
+ * arena_uninit() - Free everything in an arena
+ *
+ * The arena can be used again afterwards.
+ *
+ * @arena: Arena to empty
+ */
+void arena_uninit(struct arena *arena);
+
+#endif
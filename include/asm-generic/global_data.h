@@ -231,6 +231,13 @@ struct global_data {
 	 */
 	void *dm_priv_base;
 # endif
+# if CONFIG_IS_ENABLED(DM_MATCH_INDEX)
+	/**
+	 * @dm_match_index: hash index used to match devicetree compatible
+	 * strings to drivers, see lists_driver_match_compat()
+	 */
+	void *dm_match_index;
+# endif
 #endif
 #ifdef CONFIG_TIMER
 	/**
@@ -542,6 +549,14 @@ static_assert(sizeof(struct global_data) == GD_SIZE);
 #define gd_dm_priv_base()		NULL
 #endif
 
+#if CONFIG_IS_ENABLED(DM_MATCH_INDEX)
+#define gd_set_dm_match_index(idx)	gd->dm_match_index = idx
+#define gd_dm_match_index()		gd->dm_match_index
+#else
+#define gd_set_dm_match_index(idx)
+#define gd_dm_match_index()		NULL
+#endif
+
 #ifdef CONFIG_ACPI
 #define gd_acpi_ctx()		gd->acpi_ctx
 #define gd_acpi_start()		gd->acpi_start
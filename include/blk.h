@@ -23,6 +23,7 @@ typedef ulong lbaint_t;
 
 #define DEFAULT_BLKSZ		512
 
+struct gpt_table;
 struct udevice;
 
 static inline bool blk_enabled(void)
@@ -80,6 +81,9 @@ struct blk_desc {
 		uint32_t mbr_sig;	/* MBR integer signature */
 		efi_guid_t guid_sig;	/* GPT GUID Signature */
 	};
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+	struct gpt_table *gpt_cache;	/* validated GPT, see part_efi.c */
+#endif
 #if CONFIG_IS_ENABLED(BLK)
 	/*
 	 * For now we have a few functions which take struct blk_desc as a
@@ -637,6 +641,25 @@ struct blk_driver *blk_driver_lookup_type(int uclass_id);
 
 #endif /* !CONFIG_BLK */
 
+/**
+ * blk_dwrite_changed() - Write to a block device, skipping unchanged blocks
+ *
+ * This reads back the blocks to be written, a chunk at a time, and only
+ * writes those whose contents differ from @buffer. It suits re-flashing an
+ * image which has hardly changed, since reads are cheaper than writes and do
+ * not wear out the device. If the old contents cannot be read the blocks are
+ * simply written.
+ *
+ * @desc: Block device to write to
+ * @start: Start block for the write
+ * @blkcnt: Number of blocks to write
+ * @buffer: Data to write
+ * Return: number of blocks written or found to be unchanged, which may be
+ * less than @blkcnt, or -ve on error
+ */
+long blk_dwrite_changed(struct blk_desc *desc, lbaint_t start,
+			lbaint_t blkcnt, const void *buffer);
+
 /**
  * blk_get_devnum_by_uclass_idname() - Get a block device by type and number
  *
@@ -212,6 +212,11 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_DM_BIND_F,
+	BOOTSTAGE_ID_ACCUM_DM_BIND_R,
+	BOOTSTAGE_ID_ACCUM_FDT_FIXUP,
+	BOOTSTAGE_ID_ACCUM_FDT_BOARD,
+	BOOTSTAGE_ID_ACCUM_UBI_ATTACH,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -337,6 +342,24 @@ uint32_t bootstage_accum(enum bootstage_id id);
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * bootstage_export_json() - Write bootstage records as trace-event JSON
+ *
+ * This produces the Chrome trace-event format, which can be loaded into
+ * chrome://tracing or https://ui.perfetto.dev for viewing. Marks appear as a
+ * contiguous series of spans on one track and accumulated records as instant
+ * events on a second track.
+ *
+ * The output is nul-terminated if @size is non-zero, but is truncated if it
+ * does not fit.
+ *
+ * @buf:	Buffer to write to
+ * @size:	Size of buffer in bytes
+ * Return: number of bytes needed for the output, excluding the terminator.
+ *	If this is >= @size, the output was truncated
+ */
+int bootstage_export_json(char *buf, int size);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -433,6 +456,11 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline int bootstage_export_json(char *buf, int size)
+{
+	return 0;
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
@@ -67,6 +67,19 @@ void flush_cache(unsigned long addr, unsigned long size);
 void flush_dcache_all(void);
 void flush_dcache_range(unsigned long start, unsigned long stop);
 void invalidate_dcache_range(unsigned long start, unsigned long stop);
+
+/**
+ * flush_dcache_range_check() - Flush a range and say whether it was flushed
+ *
+ * Some caches can only flush certain ranges, and flush_dcache_range() quietly
+ * skips any others. This is for callers which need to know, such as
+ * 'mtest -c'. The default calls flush_dcache_range() and returns 0.
+ *
+ * @start: Start address of the range
+ * @stop: End address of the range (exclusive)
+ * Return: 0 if OK, -ERANGE if the range could not be flushed
+ */
+int flush_dcache_range_check(unsigned long start, unsigned long stop);
 void invalidate_dcache_all(void);
 void invalidate_icache_all(void);
 
@@ -295,12 +295,25 @@ static inline __attribute_const__ bool dev_has_ofnode(const struct udevice *dev)
 #endif
 }
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX) && CONFIG_IS_ENABLED(OF_REAL)
+/**
+ * dev_set_ofnode() - Set the devicetree node of a device
+ *
+ * If the device is bound, this also updates its uclass's device index, see
+ * CONFIG_DM_UCLASS_INDEX
+ *
+ * @dev: Device to update
+ * @node: New node
+ */
+void dev_set_ofnode(struct udevice *dev, ofnode node);
+#else
 static inline void dev_set_ofnode(struct udevice *dev, ofnode node)
 {
 #if CONFIG_IS_ENABLED(OF_REAL)
 	dev->node_ = node;
 #endif
 }
+#endif
 
 static inline int dev_seq(const struct udevice *dev)
 {
@@ -12,6 +12,8 @@
 #include <dm/ofnode.h>
 #include <dm/uclass-id.h>
 
+struct udevice_id;
+
 /**
  * lists_driver_lookup_name() - Return u_boot_driver corresponding to name
  *
@@ -45,6 +47,21 @@ struct uclass_driver *lists_uclass_lookup(enum uclass_id id);
  */
 int lists_bind_drivers(struct udevice *parent, bool pre_reloc_only);
 
+/**
+ * lists_driver_match_compat() - Find the driver for a compatible string
+ *
+ * This returns the first driver (in linker-list order) which has @compat in
+ * its of_match table. With CONFIG_DM_MATCH_INDEX this uses a hash index that
+ * is built on first use, otherwise it scans all drivers.
+ *
+ * @compat: Compatible string to look up
+ * @drvp: Returns the driver that matched
+ * @idp: Returns the of_match entry that matched
+ * Return: 0 if found, -ENOENT if no driver has this compatible string
+ */
+int lists_driver_match_compat(const char *compat, struct driver **drvp,
+			      const struct udevice_id **idp);
+
 /**
  * lists_bind_fdt() - bind a device tree node
  *
@@ -77,6 +77,17 @@
  */
 void uclass_set_priv(struct uclass *uc, void *priv);
 
+/**
+ * uclass_set_device_seq() - Change the sequence number of a bound device
+ *
+ * This must be used instead of writing dev->seq_ directly once the device has
+ * been bound, so that the uclass's device index stays up to date.
+ *
+ * @dev:	Device to update
+ * @seq:	New sequence number (-1 for none)
+ */
+void uclass_set_device_seq(struct udevice *dev, int seq);
+
 /**
  * uclass_find_next_free_seq() - Get the next free sequence number
  *
@@ -14,6 +14,31 @@
 #include <linker_lists.h>
 #include <linux/list.h>
 
+struct uclass_hent;
+
+/**
+ * struct uclass_index - Hash index of the devices in a uclass
+ *
+ * The index is built from the device list on the first lookup after
+ * relocation. From then on devices are entered under each key they have
+ * (sequence number, ofnode and phandle) when they are bound and removed when
+ * they are unbound. Entries with the same key are kept in binding order, so
+ * lookups find the same device as a walk of the uclass's device list.
+ *
+ * @count: Number of entries in the index
+ * @mask: Number of buckets, minus 1 (always a power of two)
+ * @built: true once the index has been built
+ * @broken: true if an allocation failed, so the index cannot be used
+ * @bucket: Hash buckets, NULL if nothing has been added yet
+ */
+struct uclass_index {
+	uint count;
+	uint mask;
+	bool built;
+	bool broken;
+	struct uclass_hent **bucket;
+};
+
 /**
  * struct uclass - a U-Boot drive class, collecting together similar drivers
  *
@@ -30,12 +55,17 @@
  * @dev_head: List of devices in this uclass (devices are attached to their
  * uclass when their bind method is called)
  * @sibling_node: Next uclass in the linked list of uclasses
+ * @index: Hash index of the devices in @dev_head by sequence number, ofnode
+ * and phandle (do not access outside driver model)
  */
 struct uclass {
 	void *priv_;
 	struct uclass_driver *uc_drv;
 	struct list_head dev_head;
 	struct list_head sibling_node;
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+	struct uclass_index index;
+#endif
 };
 
 struct driver;
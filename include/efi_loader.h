@@ -792,6 +792,8 @@ efi_status_t efi_setup_loaded_image(struct efi_device_path *device_path,
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 extern void *efi_bounce_buffer;
+/* Number of bytes of block I/O which went through the bounce buffer */
+extern u64 efi_disk_bounced;
 #define EFI_LOADER_BOUNCE_BUFFER_SIZE (64 * 1024 * 1024)
 #endif
 
@@ -182,6 +182,10 @@ typedef struct {
 	__u32	root_cluster;	/* First cluster of root dir for FAT32 */
 	u32	total_sect;	/* Number of sectors */
 	int	fats;		/* Number of FATs */
+	ulong	*free_map;	/* Clusters in use, built on first allocation */
+	u32	max_clust;	/* Number of clusters covered by free_map */
+	u32	free_clusts;	/* Number of clear bits in free_map */
+	u32	next_free;	/* Where the next-fit search starts */
 } fsdata;
 
 struct fat_itr;
@@ -242,6 +242,20 @@ void set_working_fdt_addr(ulong addr);
 int fdt_shrink_to_minimum(void *blob, uint extrasize);
 int fdt_increase_size(void *fdt, int add_len);
 
+/**
+ * fdt_ensure_space() - Make sure a device tree has room for more nodes
+ *
+ * Unlike fdt_increase_size() this leaves the tree alone if it already has
+ * enough free space and its blocks are in the order libfdt needs to edit it.
+ * Growing a tree in place means moving all of it, so fixups which each ask for
+ * a little more room can share the space reserved when the tree was relocated.
+ *
+ * @fdt: FDT blob to update
+ * @len: Number of free bytes needed at the end of the tree
+ * Return: 0 if ok, or -FDT_ERR_... on error
+ */
+int fdt_ensure_space(void *fdt, int len);
+
 int fdt_delete_disabled_nodes(void *blob);
 
 struct node_info;
@@ -0,0 +1,33 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Helper functions for working with the builtin symbol table
+ */
+
+#ifndef __KALLSYMS_H
+#define __KALLSYMS_H
+
+/**
+ * symbol_lookup() - Find the symbol containing an address
+ *
+ * @addr: Address to look up, as a link-time (unrelocated) address
+ * @caddr: Returns the start address of the symbol
+ * Return: symbol name, or NULL if @addr is before the first symbol
+ */
+const char *symbol_lookup(unsigned long addr, unsigned long *caddr);
+
+/**
+ * symbol_lookup_range() - Find the symbol containing an address, and its end
+ *
+ * This is like symbol_lookup() but also returns the start address of the
+ * following symbol. Callers looking up many sorted addresses can use this to
+ * skip lookups for addresses which fall in the same symbol.
+ *
+ * @addr: Address to look up, as a link-time (unrelocated) address
+ * @caddr: Returns the start address of the symbol
+ * @naddr: Returns the start address of the following symbol, or ~0UL if none
+ * Return: symbol name, or NULL if @addr is before the first symbol
+ */
+const char *symbol_lookup_range(unsigned long addr, unsigned long *caddr,
+				unsigned long *naddr);
+
+#endif
@@ -51,6 +51,8 @@ struct lmb_property {
  *         lmb_region.region is only a pointer to the correct buffer,
  *         initialized in lmb_init(). This configuration is useful to manage
  *         more reserved memory regions with CONFIG_LMB_RESERVED_REGIONS.
+ *         When a buffer is full it is moved to the heap and grown, so the
+ *         configured sizes are only the initial number of regions.
  */
 
 /**
@@ -58,7 +60,8 @@ struct lmb_property {
  *
  * @cnt: Number of regions.
  * @max: Size of the region array, max value of cnt.
- * @region: Array of the region properties
+ * @region: Array of the region properties, sorted by base address
+ * @heap: true if @region has been moved to the heap to make it larger
  */
 struct lmb_region {
 	unsigned long cnt;
@@ -67,6 +70,7 @@ struct lmb_region {
 	struct lmb_property region[CONFIG_LMB_MAX_REGIONS];
 #else
 	struct lmb_property *region;
+	bool heap;
 #endif
 };
 
@@ -93,6 +97,16 @@ struct lmb {
 };
 
 void lmb_init(struct lmb *lmb);
+/**
+ * lmb_uninit() - free the memory used by a logical memory block struct
+ *
+ * Region arrays which have grown are moved to the heap, so this must be called
+ * once @lmb is no longer needed. Afterwards @lmb is empty and can be used
+ * again.
+ *
+ * @lmb:	the logical memory block struct
+ */
+void lmb_uninit(struct lmb *lmb);
 void lmb_init_and_reserve(struct lmb *lmb, struct bd_info *bd, void *fdt_blob);
 void lmb_init_and_reserve_range(struct lmb *lmb, phys_addr_t base,
 				phys_size_t size, void *fdt_blob);
@@ -9,6 +9,7 @@
 #ifndef __LOG_H
 #define __LOG_H
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <linker_lists.h>
 #include <dm/uclass-id.h>
@@ -420,7 +421,10 @@ enum log_device_flags {
  *
  * @name: Name of driver
  * @emit: Method to call to emit a log record via this device
+ * @emit_fmt: Method to call to emit an unformatted log record
  * @flags: Initial value for flags (use LOGDF_ENABLE to enable on start-up)
+ * @level: Maximum level to accept when the device has no filters, or 0 to use
+ *	the default log level
  */
 struct log_driver {
 	const char *name;
@@ -432,7 +436,18 @@ struct log_driver {
 	 * for processing. The filter is checked before calling this function.
 	 */
 	int (*emit)(struct log_device *ldev, struct log_rec *rec);
+
+	/**
+	 * @emit_fmt: emit a log record before it is formatted
+	 *
+	 * If provided, this is called instead of @emit. @rec->msg is not set;
+	 * the driver gets the format string and arguments instead, so the
+	 * message is only formatted if some other device needs it.
+	 */
+	int (*emit_fmt)(struct log_device *ldev, struct log_rec *rec,
+			const char *fmt, va_list args);
 	unsigned short flags;
+	unsigned short level;
 };
 
 /**
@@ -658,6 +673,61 @@ int log_remove_filter(const char *drv_name, int filter_num);
  */
 int log_device_set_enable(struct log_driver *drv, bool enable);
 
+/**
+ * log_ring_add() - Add a record to the ring for this CPU
+ *
+ * This stores the format pointer and a copy of the arguments. Arguments which
+ * cannot safely be kept, such as %pU, cause the message to be formatted now
+ * instead.
+ *
+ * @rec: Log record, with @msg unused
+ * @fmt: printf() format string
+ * @args: Arguments for @fmt
+ * Return: 0 if OK, -EAGAIN if the ring is not set up yet, -ENOENT if this CPU
+ *	has no ring
+ */
+int log_ring_add(struct log_rec *rec, const char *fmt, va_list args);
+
+/**
+ * log_ring_show() - Format and print the records in all rings
+ *
+ * Records are shown oldest first, one CPU at a time.
+ */
+void log_ring_show(void);
+
+/**
+ * log_ring_export() - Format the records in all rings into a buffer
+ *
+ * The output is the same text as log_ring_show(). It is nul-terminated if
+ * @size is non-zero, but only complete lines are written.
+ *
+ * @buf: Buffer to write to
+ * @size: Size of buffer in bytes
+ * Return: number of bytes needed for all the output, excluding the terminator
+ */
+int log_ring_export(char *buf, int size);
+
+/**
+ * log_ring_cpu() - Get the number of the CPU which is logging
+ *
+ * This is provided by the architecture if it has secondary CPUs which can
+ * log. The default returns 0.
+ *
+ * Return: CPU number, used to select its ring
+ */
+uint log_ring_cpu(void);
+
+/**
+ * log_ring_secondary() - Check if running on a secondary CPU
+ *
+ * Records from a secondary CPU only go to its ring, so that it does not use
+ * the console or other log devices, which are not safe to share. The default
+ * returns false.
+ *
+ * Return: true if this is not the boot CPU
+ */
+bool log_ring_secondary(void);
+
 #if CONFIG_IS_ENABLED(LOG)
 /**
  * log_init() - Set up the log system ready for use
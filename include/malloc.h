@@ -895,6 +895,97 @@ void malloc_enable_testing(int max_allocs);
 /** malloc_disable_testing() - Put malloc() into normal mode */
 void malloc_disable_testing(void);
 
+/**
+ * struct malloc_info - Heap usage, as returned by malloc_get_info()
+ *
+ * @total: Size of the heap in bytes
+ * @in_use: Bytes in allocated chunks, including overhead. Chunks held in the
+ *	per-CPU caches are not included.
+ * @peak: Most of the heap ever claimed from the top, in bytes. Memory below
+ *	this point was in use at some time; memory above it never was.
+ * @free: Free bytes, including the part of the heap not yet claimed but not
+ *	the per-CPU caches
+ * @free_chunks: Number of free chunks in the bins, not counting the top
+ * @largest_free: Size of the largest free chunk, i.e. the largest allocation
+ *	which can currently succeed (plus overhead)
+ * @cached: Bytes held in the per-CPU caches (CONFIG_SYS_MALLOC_CACHE)
+ * @cached_chunks: Number of chunks in the per-CPU caches
+ * @cache_hits: Allocations satisfied from the per-CPU caches
+ * @cache_misses: Cacheable allocations which were not
+ */
+struct malloc_info {
+	ulong total;
+	ulong in_use;
+	ulong peak;
+	ulong free;
+	ulong free_chunks;
+	ulong largest_free;
+	ulong cached;
+	ulong cached_chunks;
+	ulong cache_hits;
+	ulong cache_misses;
+};
+
+/**
+ * malloc_get_info() - Get information about heap usage
+ *
+ * This walks the free lists so takes time proportional to the number of free
+ * chunks. Everything is zero before the heap is set up.
+ *
+ * @info: Returns the information
+ */
+void malloc_get_info(struct malloc_info *info);
+
+/**
+ * malloc_cache_fill() - Give a CPU some cached chunks to allocate from
+ *
+ * With CONFIG_SYS_MALLOC_CACHE, a secondary CPU can only allocate chunks
+ * which are in its cache. Call this on the boot CPU before handing work to
+ * another CPU, to cover what that work will allocate.
+ *
+ * @cpu: CPU number, as returned by malloc_cache_cpu()
+ * @bytes: Size of each allocation which will be made
+ * @count: Number of chunks to add
+ * Return: 0 if OK, -EINVAL if @cpu is not valid or @bytes is too large to
+ *	cache, -ENOMEM if out of memory
+ */
+int malloc_cache_fill(uint cpu, size_t bytes, uint count);
+
+/**
+ * malloc_cache_flush() - Give back the chunks cached by a CPU
+ *
+ * This empties the cache of @cpu, along with any chunks too large to cache
+ * which it has freed while running as a secondary CPU. They all go straight
+ * back to the bins, not into the cache of the calling CPU, so they can be
+ * merged again.
+ *
+ * This must be called on the boot CPU, while @cpu is not allocating or
+ * freeing memory.
+ *
+ * @cpu: CPU number, as returned by malloc_cache_cpu()
+ */
+void malloc_cache_flush(uint cpu);
+
+/**
+ * malloc_cache_cpu() - Get the number of the current CPU
+ *
+ * This selects the cache used by malloc() and free(). The default returns 0;
+ * architectures which run code on more than one CPU can override it.
+ *
+ * Return: CPU number, from 0 to CONFIG_SYS_MALLOC_CACHE_CPUS - 1
+ */
+uint malloc_cache_cpu(void);
+
+/**
+ * malloc_cache_secondary() - Check whether this is a secondary CPU
+ *
+ * Secondary CPUs only allocate from, and free to, their own cache. The
+ * default returns false.
+ *
+ * Return: true if running on a CPU other than the boot CPU
+ */
+bool malloc_cache_secondary(void);
+
 #if CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
 #define malloc malloc_simple
 #define realloc realloc_simple
@@ -509,6 +509,17 @@ void os_relaunch(char *argv[]);
  */
 int os_setup_signal_handlers(void);
 
+/**
+ * os_profile_timer() - start or stop the profiling timer
+ *
+ * This delivers SIGPROF every @period_us of CPU time used, which is passed to
+ * os_signal_action() with the interrupted program counter.
+ *
+ * @period_us:	sampling period in microseconds, or 0 to stop the timer
+ * Return:	0 for success, -ve on error
+ */
+int os_profile_timer(unsigned long period_us);
+
 /**
  * os_signal_action() - handle a signal
  *
@@ -467,6 +467,20 @@ struct part_driver {
 	int (*get_info)(struct blk_desc *desc, int part,
 			struct disk_partition *info);
 
+	/**
+	 * @find_name:		Find a partition by name (optional)
+	 *
+	 * If this is not provided, part_get_info_by_name() calls
+	 * @get_info for each partition in turn.
+	 *
+	 * @find_name.desc:	Block device descriptor
+	 * @find_name.name:	Partition name to look for
+	 * @find_name.Return:
+	 * partition number (1 = first) if found, -ENOENT if not found, other
+	 * -ve on error
+	 */
+	int (*find_name)(struct blk_desc *desc, const char *name);
+
 	/**
 	 * @print:		Print partition information
 	 *
@@ -625,6 +639,39 @@ int get_disk_guid(struct blk_desc *desc, char *guid);
 
 #endif
 
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+/**
+ * part_efi_cache_invalidate() - Drop the cached GPT for a device
+ *
+ * This must be called when the medium may have changed.
+ *
+ * @desc:	block device descriptor
+ */
+void part_efi_cache_invalidate(struct blk_desc *desc);
+
+/**
+ * part_efi_cache_write() - Note that blocks are being written or erased
+ *
+ * The cached GPT is dropped if the blocks are outside the usable area
+ * described by the GPT, i.e. if they may hold the GPT itself.
+ *
+ * @desc:	block device descriptor
+ * @start:	first block being written
+ * @blkcnt:	number of blocks being written
+ */
+void part_efi_cache_write(struct blk_desc *desc, lbaint_t start,
+			  lbaint_t blkcnt);
+#else
+static inline void part_efi_cache_invalidate(struct blk_desc *desc)
+{
+}
+
+static inline void part_efi_cache_write(struct blk_desc *desc, lbaint_t start,
+					lbaint_t blkcnt)
+{
+}
+#endif
+
 #if CONFIG_IS_ENABLED(DOS_PARTITION)
 /**
  * is_valid_dos_buf() - Ensure that a DOS MBR image is valid
@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Sampling profiler
+ *
+ * This records the program counter on a periodic timer interrupt. Unlike
+ * function tracing (CONFIG_TRACE) it needs no compiler instrumentation, so
+ * the image and its timing are unchanged while the profiler is stopped.
+ */
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include <linux/types.h>
+
+/**
+ * profile_start() - Start collecting samples
+ *
+ * Any samples from a previous run are discarded.
+ *
+ * @period_us: Sampling period in microseconds
+ * Return: 0 if OK, -ENOMEM if the sample buffer cannot be allocated, or other
+ *	-ve error from the architecture code
+ */
+int profile_start(ulong period_us);
+
+/**
+ * profile_stop() - Stop collecting samples
+ *
+ * This does nothing if the profiler is not running.
+ */
+void profile_stop(void);
+
+/**
+ * profile_show() - Print a flat profile of the samples collected
+ *
+ * Samples are attributed to the function containing them, if CONFIG_KALLSYMS
+ * is enabled, otherwise to the sampled address itself. Functions are listed
+ * with the most samples first.
+ *
+ * @max_funcs: Maximum number of functions to list
+ * Return: 0 if OK, -EBUSY if the profiler is running, -ENOMEM if out of memory
+ */
+int profile_show(uint max_funcs);
+
+/**
+ * profile_sample() - Record a sample
+ *
+ * This is called from the timer interrupt (or signal handler on sandbox). It
+ * does nothing if the profiler is not running.
+ *
+ * @pc: Program counter at the time of the interrupt
+ */
+void profile_sample(ulong pc);
+
+/**
+ * arch_profile_start() - Start the periodic sampling interrupt
+ *
+ * The interrupt handler must call profile_sample() on each tick.
+ *
+ * @period_us: Sampling period in microseconds
+ * Return: 0 if OK, -ve on error
+ */
+int arch_profile_start(ulong period_us);
+
+/**
+ * arch_profile_stop() - Stop the periodic sampling interrupt
+ */
+void arch_profile_stop(void);
+
+#endif
@@ -79,6 +79,26 @@ struct pxe_menu {
 	struct list_head labels;
 };
 
+/**
+ * struct pxe_file - A file which has been read into memory
+ *
+ * This allows a file to be used again without fetching it, e.g. when several
+ * labels share the same kernel and the first one fails to boot.
+ *
+ * @path: Full path of the file, as passed to getfile()
+ * @addr: Address the file was read to
+ * @size: Size of the file in bytes
+ * @crc: CRC32 of the file as read, used to check that it is still intact
+ * @sibling: Node in the context's list of files
+ */
+struct pxe_file {
+	char *path;
+	ulong addr;
+	ulong size;
+	u32 crc;
+	struct list_head sibling;
+};
+
 struct pxe_context;
 typedef int (*pxe_getfile_func)(struct pxe_context *ctx, const char *file_path,
 				char *file_addr, ulong *filesizep);
@@ -94,6 +114,8 @@ typedef int (*pxe_getfile_func)(struct pxe_context *ctx, const char *file_path,
  *	allocated
  * @pxe_file_size: Size of the PXE file
  * @use_ipv6: TRUE : use IPv6 addressing, FALSE : use IPv4 addressing
+ * @files: List of files read so far (struct pxe_file), used with
+ *	CONFIG_PXE_FILE_CACHE
  */
 struct pxe_context {
 	struct cmd_tbl *cmdtp;
@@ -114,6 +136,7 @@ struct pxe_context {
 	char *bootdir;
 	ulong pxe_file_size;
 	bool use_ipv6;
+	struct list_head files;
 };
 
 /**
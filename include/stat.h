@@ -0,0 +1,158 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Hot-path event counters
+ *
+ * Counters and histograms are declared statically next to the code that
+ * updates them and collected into a linker list, so that the 'stats' command
+ * can find them without any registration at run time. Updating one is a
+ * single increment of a variable in .data. When CONFIG_STATS is disabled (and
+ * always in SPL) the declarations and updates compile away entirely.
+ */
+
+#ifndef __STAT_H
+#define __STAT_H
+
+#include <linker_lists.h>
+#include <linux/bitops.h>
+#include <linux/kernel.h>
+
+enum {
+	/* Number of buckets in a histogram, see stat_hist_add() */
+	STAT_HIST_BUCKETS	= 16,
+};
+
+/**
+ * enum stat_type - Type of statistic
+ *
+ * @STAT_COUNTER: A single count
+ * @STAT_HIST: A histogram with STAT_HIST_BUCKETS power-of-two buckets
+ */
+enum stat_type {
+	STAT_COUNTER,
+	STAT_HIST,
+};
+
+/**
+ * struct stat_entry - Describes a statistic
+ *
+ * The value itself lives in a separate variable, since linker-list entries
+ * are not expected to change at run time.
+ *
+ * @subsys: Subsystem which owns the statistic, e.g. "blk"
+ * @name: Name of the statistic within the subsystem, e.g. "read_blocks"
+ * @type: Type of statistic
+ * @data: Value (STAT_COUNTER) or array of STAT_HIST_BUCKETS values (STAT_HIST)
+ */
+struct stat_entry {
+	const char *subsys;
+	const char *name;
+	enum stat_type type;
+	ulong *data;
+};
+
+#if CONFIG_IS_ENABLED(STATS)
+
+/*
+ * The values are placed in .data rather than .bss, since some of them are
+ * updated before relocation, when .bss overlaps the device tree
+ */
+#define __STAT_DEFINE(_subsys, _name, _type, _count)			\
+	static ulong stat_##_subsys##_##_name[_count] __section(".data");	\
+	ll_entry_declare(struct stat_entry, _subsys##_##_name, stat) = {	\
+		.subsys = #_subsys,					\
+		.name = #_name,						\
+		.type = _type,						\
+		.data = stat_##_subsys##_##_name,			\
+	}
+
+/**
+ * STAT_COUNTER_DEFINE() - Define a counter
+ *
+ * This must be used at file scope in the file which updates the counter.
+ *
+ * @_subsys: Subsystem name (an identifier, not a string)
+ * @_name: Counter name (an identifier, not a string)
+ */
+#define STAT_COUNTER_DEFINE(_subsys, _name)				\
+	__STAT_DEFINE(_subsys, _name, STAT_COUNTER, 1)
+
+/**
+ * STAT_HIST_DEFINE() - Define a histogram
+ *
+ * This must be used at file scope in the file which updates the histogram.
+ *
+ * @_subsys: Subsystem name (an identifier, not a string)
+ * @_name: Histogram name (an identifier, not a string)
+ */
+#define STAT_HIST_DEFINE(_subsys, _name)				\
+	__STAT_DEFINE(_subsys, _name, STAT_HIST, STAT_HIST_BUCKETS)
+
+/* Add @_val to a counter */
+#define STAT_ADD(_subsys, _name, _val)					\
+	(stat_##_subsys##_##_name[0] += (_val))
+
+/* Add a sample to a histogram */
+#define STAT_HIST_ADD(_subsys, _name, _val)				\
+	stat_hist_add(stat_##_subsys##_##_name, _val)
+
+#else
+
+#define STAT_COUNTER_DEFINE(_subsys, _name)
+#define STAT_HIST_DEFINE(_subsys, _name)
+#define STAT_ADD(_subsys, _name, _val)		do { } while (0)
+#define STAT_HIST_ADD(_subsys, _name, _val)	do { } while (0)
+
+#endif
+
+/* Add one to a counter */
+#define STAT_INC(_subsys, _name)	STAT_ADD(_subsys, _name, 1)
+
+/**
+ * stat_hist_bucket() - Get the histogram bucket for a value
+ *
+ * Bucket 0 holds zero and bucket n holds values in [2^(n-1), 2^n). The last
+ * bucket holds everything larger.
+ *
+ * @val: Value to look up
+ * Return: bucket number, 0 to STAT_HIST_BUCKETS - 1
+ */
+static inline uint stat_hist_bucket(ulong val)
+{
+	return min_t(uint, fls_long(val), STAT_HIST_BUCKETS - 1);
+}
+
+static inline void stat_hist_add(ulong *buckets, ulong val)
+{
+	buckets[stat_hist_bucket(val)]++;
+}
+
+/**
+ * stat_show() - Print statistics
+ *
+ * Statistics which have never been updated are skipped.
+ *
+ * @subsys: Subsystem to show, or NULL for all
+ */
+void stat_show(const char *subsys);
+
+/**
+ * stat_reset() - Set statistics back to zero
+ *
+ * @subsys: Subsystem to reset, or NULL for all
+ */
+void stat_reset(const char *subsys);
+
+/**
+ * stat_fdt_add() - Add statistics to a device tree
+ *
+ * This adds a 'stats' subnode with one property per statistic, named
+ * '<subsys>-<name>'. Counters are written as a 64-bit value and histograms as
+ * an array of 64-bit values, one per bucket.
+ *
+ * @blob: Device tree to update
+ * @parent: Offset of the node to add the 'stats' subnode to
+ * Return: 0 if OK, -ve on error
+ */
+int stat_fdt_add(void *blob, int parent);
+
+#endif
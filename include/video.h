@@ -84,7 +84,13 @@ enum video_format {
  * @vidconsole_drv_name:	Driver to use for the text console, NULL to
  *		select automatically
  * @font_size:	Font size in pixels (0 to use a default value)
- * @fb:		Frame buffer
+ * @pan_size:	Number of bytes of frame buffer memory, starting at the base
+ *		address in struct video_uc_plat, which the display can be
+ *		panned across with the set_start() operation. This must be at
+ *		least twice the size of the display to be of use. Leave it as 0
+ *		if the device cannot pan.
+ * @fb:		Frame buffer, which moves through the first @pan_size bytes of
+ *		frame buffer memory as the display is panned
  * @fb_size:	Frame buffer size
  * @copy_fb:	Copy of the frame buffer to keep up to date; see struct
  *		video_uc_plat
@@ -97,6 +103,11 @@ enum video_format {
  *		the LCD is updated
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
+ * @pan_pending:	true if @fb has moved and the hardware must be told with
+ *		the set_start() operation at the next video_sync()
+ * @damage_start:	Start of the part of the frame buffer changed since the
+ *		last video_sync(), see video_damage()
+ * @damage_end:	End of that part, or NULL if nothing has changed
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -107,6 +118,7 @@ struct video_priv {
 	enum video_format format;
 	const char *vidconsole_drv_name;
 	int font_size;
+	ulong pan_size;
 
 	/*
 	 * Things that are private to the uclass: don't use these in the
@@ -121,6 +133,9 @@ struct video_priv {
 	bool flush_dcache;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+	bool pan_pending;
+	void *damage_start;
+	void *damage_end;
 };
 
 /**
@@ -130,9 +145,14 @@ struct video_priv {
  *		For these devices implement video_sync hook to call a sync
  *		function. vid is pointer to video device udevice. Function
  *		should return 0 on success video_sync and error code otherwise
+ * @set_start: Show the display starting @offset bytes into the frame buffer
+ *		memory, to pan it. This is only used if the driver sets
+ *		pan_size in struct video_priv. Return 0 on success or an error
+ *		code otherwise
  */
 struct video_ops {
 	int (*video_sync)(struct udevice *vid);
+	int (*set_start)(struct udevice *vid, ulong offset);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -265,10 +285,68 @@ int video_sync(struct udevice *vid, bool force);
 /**
  * video_sync_all() - Sync all devices' frame buffers with their hardware
  *
- * This calls video_sync() on all active video devices.
+ * This calls video_sync() on all active video devices. Since the caller may
+ * have written to the frame buffers directly, the whole of each is synced.
  */
 void video_sync_all(void);
 
+/**
+ * video_damage() - Record that part of a frame buffer has changed
+ *
+ * With CONFIG_VIDEO_DAMAGE the next video_sync() only flushes the parts of
+ * the frame buffer recorded here. video_sync_copy() calls this, so drawing
+ * code which keeps the copy frame buffer up to date need do nothing more.
+ * Without CONFIG_VIDEO_DAMAGE this does nothing.
+ *
+ * @dev:	Video device
+ * @start:	First byte changed
+ * @end:	Byte after the last one changed
+ */
+void video_damage(struct udevice *dev, void *start, void *end);
+
+/**
+ * video_get_damage() - Get the part of a frame buffer which needs syncing
+ *
+ * This is for use by the video_sync() operation of drivers which flush the
+ * frame buffer themselves. Without CONFIG_VIDEO_DAMAGE it returns the whole
+ * visible frame buffer.
+ *
+ * @dev:	Video device
+ * @startp:	Returns the address of the first byte to sync
+ * @endp:	Returns the address after the last byte to sync
+ * Return: true if there is anything to sync, false if not
+ */
+bool video_get_damage(struct udevice *dev, ulong *startp, ulong *endp);
+
+/**
+ * video_pan_up() - Scroll the display up by panning
+ *
+ * This moves the visible frame buffer down through frame buffer memory by
+ * @lines pixel rows, so that scrolling does not have to move the contents.
+ * When the end of the memory is reached, the part which stays visible is
+ * copied back to the start, once. The newly visible rows at the bottom are
+ * filled with the background colour. The hardware is updated at the next
+ * video_sync().
+ *
+ * @dev:	Video device
+ * @lines:	Number of pixel rows to scroll by
+ * Return: 0 if OK, -ENOSYS if the device cannot pan, -E2BIG if @lines is not
+ *	less than the height of the display
+ */
+int video_pan_up(struct udevice *dev, int lines);
+
+/**
+ * video_pan_stop() - Stop panning a display
+ *
+ * This moves the visible frame buffer back to the start of frame buffer
+ * memory and stops video_pan_up() from panning again, for when something
+ * else, such as an EFI application, expects the frame buffer to stay put.
+ *
+ * @dev:	Video device
+ * Return: 0 if OK, -ve on error
+ */
+int video_pan_stop(struct udevice *dev);
+
 /**
  * video_bmp_get_info() - Get information about a bitmap image
  *
@@ -341,12 +419,13 @@ void video_set_default_colors(struct udevice *dev, bool invert);
  */
 int video_default_font_height(struct udevice *dev);
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 /**
  * vidconsole_sync_copy() - Sync back to the copy framebuffer
  *
  * This ensures that the copy framebuffer has the same data as the framebuffer
- * for a particular region. It should be called after the framebuffer is updated
+ * for a particular region, and records the region with video_damage(). It
+ * should be called after the framebuffer is updated
  *
  * @from and @to can be in either order. The region between them is synced.
  *
@@ -2219,6 +2219,10 @@ static efi_status_t EFIAPI efi_exit_boot_services(efi_handle_t image_handle,
 	/* Make sure that notification functions are not called anymore */
 	efi_tpl = TPL_HIGH_LEVEL;
 
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+	log_debug("Block I/O bounced: %llu bytes\n", efi_disk_bounced);
+#endif
+
 	/* Notify variable services */
 	efi_variables_boot_exit_notify();
 
@@ -11,6 +11,7 @@
 #include <blk.h>
 #include <dm.h>
 #include <dm/device-internal.h>
+#include <dm/read.h>
 #include <dm/tag.h>
 #include <event.h>
 #include <efi_driver.h>
@@ -19,6 +20,7 @@
 #include <log.h>
 #include <part.h>
 #include <malloc.h>
+#include <asm/io.h>
 
 struct efi_system_partition efi_system_partition = {
 	.uclass_id = UCLASS_INVALID,
@@ -47,8 +49,17 @@ struct efi_disk_obj {
 	struct efi_device_path *dp;
 	unsigned int part;
 	struct efi_simple_file_system_protocol *volume;
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+	phys_addr_t dma_first;
+	phys_addr_t dma_last;
+#endif
 };
 
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+/* Number of bytes which went through the bounce buffer */
+u64 efi_disk_bounced;
+#endif
+
 /**
  * efi_disk_reset() - reset block device
  *
@@ -153,6 +164,129 @@ static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
 	return EFI_SUCCESS;
 }
 
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+/**
+ * efi_disk_set_dma_window() - find the memory a disk controller can reach
+ *
+ * The window is taken from the dma-ranges of the controller in the device
+ * tree. Without dma-ranges the controller is assumed to reach the lowest
+ * CONFIG_EFI_LOADER_BOUNCE_BUFFER_DMA_BITS bits of the address space.
+ *
+ * @diskobj:	disk object
+ * @desc:	block device descriptor
+ */
+static void efi_disk_set_dma_window(struct efi_disk_obj *diskobj,
+				    struct blk_desc *desc)
+{
+	struct udevice *ctlr = desc->bdev ? dev_get_parent(desc->bdev) : NULL;
+	phys_addr_t cpu;
+	dma_addr_t bus;
+	u64 size;
+
+	if (ctlr && !dev_get_dma_range(ctlr, &cpu, &bus, &size) && size) {
+		diskobj->dma_first = cpu;
+		diskobj->dma_last = cpu + size - 1;
+	} else {
+		size = GENMASK_ULL(CONFIG_EFI_LOADER_BOUNCE_BUFFER_DMA_BITS - 1,
+				   0);
+		diskobj->dma_first = 0;
+		diskobj->dma_last = min_t(u64, size, ~(phys_addr_t)0);
+	}
+}
+
+/**
+ * efi_disk_dma_run() - get the next run of a buffer to transfer
+ *
+ * Returns the length of the longest run at the start of @buffer which is
+ * either entirely reachable by the controller or entirely unreachable. An
+ * unreachable run is limited to the size of the bounce buffer.
+ *
+ * @diskobj:	disk object
+ * @buffer:	start of the buffer
+ * @size:	number of bytes left, a multiple of the block size
+ * @bounce:	set to true if the run has to be bounced
+ * Return:	number of bytes in the run, a multiple of the block size
+ */
+static unsigned long efi_disk_dma_run(struct efi_disk_obj *diskobj,
+				      void *buffer, unsigned long size,
+				      bool *bounce)
+{
+	unsigned long blksz = diskobj->media.block_size;
+	phys_addr_t start = virt_to_phys(buffer);
+	unsigned long len;
+
+	if (start >= diskobj->dma_first && start <= diskobj->dma_last &&
+	    diskobj->dma_last - start >= blksz - 1) {
+		*bounce = false;
+		if (diskobj->dma_last - start >= size - 1)
+			return size;
+		len = diskobj->dma_last - start + 1;
+
+		return len - len % blksz;
+	}
+
+	*bounce = true;
+	len = min_t(unsigned long, size, EFI_LOADER_BOUNCE_BUFFER_SIZE);
+	if (start < diskobj->dma_first &&
+	    diskobj->dma_first - start < len)
+		len = roundup(diskobj->dma_first - start, blksz);
+
+	return len;
+}
+
+/**
+ * efi_disk_rw_bounce() - read or write blocks, bouncing where needed
+ *
+ * Parts of @buffer which the controller can reach are transferred directly.
+ * Only the other parts go through the bounce buffer.
+ *
+ * @this:		pointer to the BLOCK_IO_PROTOCOL
+ * @media_id:		id of the medium
+ * @lba:		starting logical block
+ * @buffer_size:	size of the buffer, a multiple of the block size
+ * @buffer:		buffer to read into or write from
+ * @direction:		read or write
+ * Return:		status code
+ */
+static efi_status_t efi_disk_rw_bounce(struct efi_block_io *this,
+			u32 media_id, u64 lba, unsigned long buffer_size,
+			void *buffer, enum efi_disk_direction direction)
+{
+	struct efi_disk_obj *diskobj;
+	unsigned long len;
+	efi_status_t r;
+	bool bounce;
+
+	diskobj = container_of(this, struct efi_disk_obj, ops);
+	if (buffer_size & (diskobj->media.block_size - 1))
+		return EFI_BAD_BUFFER_SIZE;
+
+	while (buffer_size) {
+		len = efi_disk_dma_run(diskobj, buffer, buffer_size, &bounce);
+		if (!bounce) {
+			r = efi_disk_rw_blocks(this, media_id, lba, len, buffer,
+					       direction);
+		} else {
+			if (direction == EFI_DISK_WRITE)
+				memcpy(efi_bounce_buffer, buffer, len);
+			r = efi_disk_rw_blocks(this, media_id, lba, len,
+					       efi_bounce_buffer, direction);
+			if (r == EFI_SUCCESS && direction == EFI_DISK_READ)
+				memcpy(buffer, efi_bounce_buffer, len);
+			efi_disk_bounced += len;
+		}
+		if (r != EFI_SUCCESS)
+			return r;
+
+		buffer += len;
+		buffer_size -= len;
+		lba += len / diskobj->media.block_size;
+	}
+
+	return EFI_SUCCESS;
+}
+#endif
+
 /**
  * efi_disk_read_blocks() - reads blocks from device
  *
@@ -172,7 +306,6 @@ static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
 			u32 media_id, u64 lba, efi_uintn_t buffer_size,
 			void *buffer)
 {
-	void *real_buffer = buffer;
 	efi_status_t r;
 
 	if (!this)
@@ -190,30 +323,16 @@ static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
 	    (this->media->last_block + 1) * this->media->block_size)
 		return EFI_INVALID_PARAMETER;
 
-#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
-	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_read_blocks(this, media_id, lba,
-			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
-		if (r != EFI_SUCCESS)
-			return r;
-		return efi_disk_read_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
-			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
-			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
-	}
-
-	real_buffer = efi_bounce_buffer;
-#endif
-
 	EFI_ENTRY("%p, %x, %llx, %zx, %p", this, media_id, lba,
 		  buffer_size, buffer);
 
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+	r = efi_disk_rw_bounce(this, media_id, lba, buffer_size, buffer,
 			       EFI_DISK_READ);
-
-	/* Copy from bounce buffer to real buffer if necessary */
-	if ((r == EFI_SUCCESS) && (real_buffer != buffer))
-		memcpy(buffer, real_buffer, buffer_size);
+#else
+	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, buffer,
+			       EFI_DISK_READ);
+#endif
 
 	return EFI_EXIT(r);
 }
@@ -238,7 +357,6 @@ static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
 			u32 media_id, u64 lba, efi_uintn_t buffer_size,
 			void *buffer)
 {
-	void *real_buffer = buffer;
 	efi_status_t r;
 
 	if (!this)
@@ -258,30 +376,16 @@ static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
 	    (this->media->last_block + 1) * this->media->block_size)
 		return EFI_INVALID_PARAMETER;
 
-#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
-	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_write_blocks(this, media_id, lba,
-			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
-		if (r != EFI_SUCCESS)
-			return r;
-		return efi_disk_write_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
-			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
-			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
-	}
-
-	real_buffer = efi_bounce_buffer;
-#endif
-
 	EFI_ENTRY("%p, %x, %llx, %zx, %p", this, media_id, lba,
 		  buffer_size, buffer);
 
-	/* Populate bounce buffer if necessary */
-	if (real_buffer != buffer)
-		memcpy(real_buffer, buffer, buffer_size);
-
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+	r = efi_disk_rw_bounce(this, media_id, lba, buffer_size, buffer,
 			       EFI_DISK_WRITE);
+#else
+	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, buffer,
+			       EFI_DISK_WRITE);
+#endif
 
 	return EFI_EXIT(r);
 }
@@ -514,6 +618,9 @@ static efi_status_t efi_disk_add_dev(
 	if (part)
 		diskobj->media.logical_partition = 1;
 	diskobj->ops.media = &diskobj->media;
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+	efi_disk_set_dma_window(diskobj, desc);
+#endif
 	if (disk)
 		*disk = diskobj;
 
@@ -479,6 +479,9 @@ efi_status_t efi_gop_register(void)
 		return EFI_SUCCESS;
 	}
 
+	/* The frame buffer given to the application must stay where it is */
+	video_pan_stop(vdev);
+
 	priv = dev_get_uclass_priv(vdev);
 	bpix = priv->bpix;
 	format = priv->format;
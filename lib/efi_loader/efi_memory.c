@@ -16,7 +16,7 @@
 #include <watchdog.h>
 #include <asm/cache.h>
 #include <asm/global_data.h>
-#include <linux/list_sort.h>
+#include <linux/rbtree.h>
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -26,18 +26,26 @@ DECLARE_GLOBAL_DATA_PTR;
 
 efi_uintn_t efi_memory_map_key;
 
+/**
+ * struct efi_mem_list - memory map item
+ *
+ * @node:	node in the tree of all items, ordered by address
+ * @free_node:	node in the tree of free items, only used for items of type
+ *		EFI_CONVENTIONAL_MEMORY
+ * @desc:	memory descriptor
+ */
 struct efi_mem_list {
-	struct list_head link;
+	struct rb_node node;
+	struct rb_node free_node;
 	struct efi_mem_desc desc;
 };
 
-#define EFI_CARVE_NO_OVERLAP		-1
-#define EFI_CARVE_LOOP_AGAIN		-2
-#define EFI_CARVE_OVERLAPS_NONRAM	-3
-#define EFI_CARVE_OUT_OF_RESOURCES	-4
-
-/* This list contains all memory map items */
-static LIST_HEAD(efi_mem);
+/* This tree contains all memory map items, ordered by address */
+static struct rb_root efi_mem = RB_ROOT;
+/* This tree contains the free (EFI_CONVENTIONAL_MEMORY) items */
+static struct rb_root efi_free_mem = RB_ROOT;
+/* Number of items in the memory map */
+static efi_uintn_t efi_mem_count;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 void *efi_bounce_buffer;
@@ -83,176 +91,249 @@ static u64 checksum(struct efi_pool_allocation *alloc)
 }
 
 /**
- * efi_mem_cmp() - comparator function for sorting memory map
+ * desc_get_end() - get end address of memory area
  *
- * Sorts the memory list from highest address to lowest address
+ * @desc:	memory descriptor
+ * Return:	end address + 1
+ */
+static uint64_t desc_get_end(struct efi_mem_desc *desc)
+{
+	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
+}
+
+/**
+ * efi_mem_tree_add() - add a memory map item to one of the trees
  *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
+ * @mem:	memory map item
+ * @free:	add to the tree of free items instead of the tree of all items
+ */
+static void efi_mem_tree_add(struct efi_mem_list *mem, bool free)
+{
+	struct rb_root *root = free ? &efi_free_mem : &efi_mem;
+	struct rb_node **link = &root->rb_node;
+	struct rb_node *parent = NULL;
+	struct efi_mem_list *cur;
+
+	while (*link) {
+		parent = *link;
+		if (free)
+			cur = rb_entry(parent, struct efi_mem_list, free_node);
+		else
+			cur = rb_entry(parent, struct efi_mem_list, node);
+		if (mem->desc.physical_start < cur->desc.physical_start)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+
+	if (free) {
+		rb_link_node(&mem->free_node, parent, link);
+		rb_insert_color(&mem->free_node, root);
+	} else {
+		rb_link_node(&mem->node, parent, link);
+		rb_insert_color(&mem->node, root);
+	}
+}
+
+/**
+ * efi_mem_insert() - insert an item into the memory map
+ *
+ * The item must not overlap any other item.
  *
- * @priv:	unused
- * @a:		first memory area
- * @b:		second memory area
- * Return:	1 if @a is before @b, -1 if @b is before @a, 0 if equal
+ * @mem:	memory map item
  */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
+static void efi_mem_insert(struct efi_mem_list *mem)
 {
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
+	efi_mem_tree_add(mem, false);
+	if (mem->desc.type == EFI_CONVENTIONAL_MEMORY)
+		efi_mem_tree_add(mem, true);
+	efi_mem_count++;
+}
 
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
+/**
+ * efi_mem_remove() - remove an item from the memory map and free it
+ *
+ * @mem:	memory map item
+ */
+static void efi_mem_remove(struct efi_mem_list *mem)
+{
+	rb_erase(&mem->node, &efi_mem);
+	if (mem->desc.type == EFI_CONVENTIONAL_MEMORY)
+		rb_erase(&mem->free_node, &efi_free_mem);
+	efi_mem_count--;
+	free(mem);
 }
 
 /**
- * desc_get_end() - get end address of memory area
+ * efi_mem_next() - get the next item in ascending address order
  *
- * @desc:	memory descriptor
- * Return:	end address + 1
+ * @mem:	memory map item
+ * Return:	next item or NULL
  */
-static uint64_t desc_get_end(struct efi_mem_desc *desc)
+static struct efi_mem_list *efi_mem_next(struct efi_mem_list *mem)
 {
-	return desc->physical_start + (desc->num_pages << EFI_PAGE_SHIFT);
+	struct rb_node *node = rb_next(&mem->node);
+
+	return node ? rb_entry(node, struct efi_mem_list, node) : NULL;
 }
 
 /**
- * efi_mem_sort() - sort memory map
+ * efi_mem_prev() - get the previous item in ascending address order
  *
- * Sort the memory map and then try to merge adjacent memory areas.
+ * @mem:	memory map item
+ * Return:	previous item or NULL
  */
-static void efi_mem_sort(void)
+static struct efi_mem_list *efi_mem_prev(struct efi_mem_list *mem)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *prevmem = NULL;
-	bool merge_again = true;
-
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
-
-	/* Now merge entries that can be merged */
-	while (merge_again) {
-		merge_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			struct efi_mem_desc *prev = &prevmem->desc;
-			struct efi_mem_desc *cur;
-			uint64_t pages;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			if (!prevmem) {
-				prevmem = lmem;
-				continue;
-			}
-
-			cur = &lmem->desc;
-
-			if ((desc_get_end(cur) == prev->physical_start) &&
-			    (prev->type == cur->type) &&
-			    (prev->attribute == cur->attribute)) {
-				/* There is an existing map before, reuse it */
-				pages = cur->num_pages;
-				prev->num_pages += pages;
-				prev->physical_start -= pages << EFI_PAGE_SHIFT;
-				prev->virtual_start -= pages << EFI_PAGE_SHIFT;
-				list_del(&lmem->link);
-				free(lmem);
-
-				merge_again = true;
-				break;
-			}
-
-			prevmem = lmem;
-		}
-	}
+	struct rb_node *node = rb_prev(&mem->node);
+
+	return node ? rb_entry(node, struct efi_mem_list, node) : NULL;
 }
 
 /**
- * efi_mem_carve_out() - unmap memory region
+ * efi_mem_find() - find the memory map item at or below an address
  *
- * @map:		memory map
- * @carve_desc:		memory region to unmap
- * @overlap_only_ram:	the carved out region may only overlap RAM
- * Return:		the number of overlapping pages which have been
- *			removed from the map,
- *			EFI_CARVE_NO_OVERLAP, if the regions don't overlap,
- *			EFI_CARVE_OVERLAPS_NONRAM, if the carve and map overlap,
- *			and the map contains anything but free ram
- *			(only when overlap_only_ram is true),
- *			EFI_CARVE_LOOP_AGAIN, if the mapping list should be
- *			traversed again, as it has been altered.
- *
- * Unmaps all memory occupied by the carve_desc region from the list entry
- * pointed to by map.
- *
- * In case of EFI_CARVE_OVERLAPS_NONRAM it is the callers responsibility
- * to re-add the already carved out pages to the mapping.
+ * @addr:	address
+ * Return:	item with the highest start address not above @addr, or NULL.
+ *		The item does not necessarily contain @addr.
  */
-static s64 efi_mem_carve_out(struct efi_mem_list *map,
-			     struct efi_mem_desc *carve_desc,
-			     bool overlap_only_ram)
+static struct efi_mem_list *efi_mem_find(u64 addr)
 {
-	struct efi_mem_list *newmap;
-	struct efi_mem_desc *map_desc = &map->desc;
-	uint64_t map_start = map_desc->physical_start;
-	uint64_t map_end = map_start + (map_desc->num_pages << EFI_PAGE_SHIFT);
-	uint64_t carve_start = carve_desc->physical_start;
-	uint64_t carve_end = carve_start +
-			     (carve_desc->num_pages << EFI_PAGE_SHIFT);
-
-	/* check whether we're overlapping */
-	if ((carve_end <= map_start) || (carve_start >= map_end))
-		return EFI_CARVE_NO_OVERLAP;
-
-	/* We're overlapping with non-RAM, warn the caller if desired */
-	if (overlap_only_ram && (map_desc->type != EFI_CONVENTIONAL_MEMORY))
-		return EFI_CARVE_OVERLAPS_NONRAM;
-
-	/* Sanitize carve_start and carve_end to lie within our bounds */
-	carve_start = max(carve_start, map_start);
-	carve_end = min(carve_end, map_end);
-
-	/* Carving at the beginning of our map? Just move it! */
-	if (carve_start == map_start) {
-		if (map_end == carve_end) {
-			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
+	struct rb_node *node = efi_mem.rb_node;
+	struct efi_mem_list *ret = NULL;
+
+	while (node) {
+		struct efi_mem_list *mem;
+
+		mem = rb_entry(node, struct efi_mem_list, node);
+		if (mem->desc.physical_start <= addr) {
+			ret = mem;
+			node = node->rb_right;
 		} else {
-			map->desc.physical_start = carve_end;
-			map->desc.virtual_start = carve_end;
-			map->desc.num_pages = (map_end - carve_end)
-					      >> EFI_PAGE_SHIFT;
+			node = node->rb_left;
 		}
+	}
+
+	return ret;
+}
+
+/**
+ * efi_mem_can_merge() - check whether two adjacent items can be merged
+ *
+ * @low:	lower memory map item
+ * @high:	higher memory map item
+ * Return:	true if @high directly follows @low and both have the same type
+ *		and attributes
+ */
+static bool efi_mem_can_merge(struct efi_mem_list *low,
+			      struct efi_mem_list *high)
+{
+	return desc_get_end(&low->desc) == high->desc.physical_start &&
+	       low->desc.type == high->desc.type &&
+	       low->desc.attribute == high->desc.attribute;
+}
+
+/**
+ * efi_mem_merge() - merge an item with its neighbours
+ *
+ * @mem:	memory map item which has just been inserted
+ */
+static void efi_mem_merge(struct efi_mem_list *mem)
+{
+	struct efi_mem_list *prev = efi_mem_prev(mem);
+	struct efi_mem_list *next = efi_mem_next(mem);
+
+	if (prev && efi_mem_can_merge(prev, mem)) {
+		/* There is an existing map before, reuse it */
+		prev->desc.num_pages += mem->desc.num_pages;
+		efi_mem_remove(mem);
+		mem = prev;
+	}
+	if (next && efi_mem_can_merge(mem, next)) {
+		mem->desc.num_pages += next->desc.num_pages;
+		efi_mem_remove(next);
+	}
+}
 
-		return (carve_end - carve_start) >> EFI_PAGE_SHIFT;
+/**
+ * efi_mem_is_free() - check that a region only contains free RAM
+ *
+ * @start:	start address
+ * @end:	end address + 1
+ * Return:	true if the whole region is EFI_CONVENTIONAL_MEMORY
+ */
+static bool efi_mem_is_free(u64 start, u64 end)
+{
+	struct efi_mem_list *mem = efi_mem_find(start);
+	u64 addr = start;
+
+	while (addr < end) {
+		if (!mem || mem->desc.physical_start > addr ||
+		    desc_get_end(&mem->desc) <= addr ||
+		    mem->desc.type != EFI_CONVENTIONAL_MEMORY)
+			return false;
+		addr = desc_get_end(&mem->desc);
+		mem = efi_mem_next(mem);
 	}
 
-	/*
-	 * Overlapping maps, just split the list map at carve_start,
-	 * it will get moved or removed in the next iteration.
-	 *
-	 * [ map_desc |__carve_start__| newmap ]
-	 */
+	return true;
+}
 
-	/* Create a new map from [ carve_start ... map_end ] */
-	newmap = calloc(1, sizeof(*newmap));
-	if (!newmap)
-		return EFI_CARVE_OUT_OF_RESOURCES;
-	newmap->desc = map->desc;
-	newmap->desc.physical_start = carve_start;
-	newmap->desc.virtual_start = carve_start;
-	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
-
-	/* Shrink the map to [ map_start ... carve_start ] */
-	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
-
-	return EFI_CARVE_LOOP_AGAIN;
+/**
+ * efi_mem_carve_out() - unmap memory region
+ *
+ * Removes the region [@start, @end) from all items in the memory map.
+ * Items which are only partially covered are shrunk. If the region lies
+ * in the middle of a single item, that item is split and @spare is used
+ * for its upper part.
+ *
+ * @start:	start address
+ * @end:	end address + 1
+ * @spare:	preallocated item, set to NULL if it was used
+ */
+static void efi_mem_carve_out(u64 start, u64 end, struct efi_mem_list **spare)
+{
+	struct efi_mem_list *mem, *next;
+	u64 mem_end;
+
+	mem = efi_mem_find(start);
+	if (!mem) {
+		struct rb_node *node = rb_first(&efi_mem);
+
+		mem = node ? rb_entry(node, struct efi_mem_list, node) : NULL;
+	} else if (desc_get_end(&mem->desc) <= start) {
+		mem = efi_mem_next(mem);
+	} else if (mem->desc.physical_start < start) {
+		mem_end = desc_get_end(&mem->desc);
+		mem->desc.num_pages = (start - mem->desc.physical_start) >>
+				      EFI_PAGE_SHIFT;
+		if (mem_end > end) {
+			/* [ mem | carve | tail ] */
+			next = *spare;
+			*spare = NULL;
+			next->desc = mem->desc;
+			next->desc.physical_start = end;
+			next->desc.virtual_start = end;
+			next->desc.num_pages = (mem_end - end) >> EFI_PAGE_SHIFT;
+			efi_mem_insert(next);
+			return;
+		}
+		mem = efi_mem_next(mem);
+	}
+
+	while (mem && mem->desc.physical_start < end) {
+		mem_end = desc_get_end(&mem->desc);
+		if (mem_end > end) {
+			/* Carving at the beginning of the item, just move it */
+			mem->desc.physical_start = end;
+			mem->desc.virtual_start = end;
+			mem->desc.num_pages = (mem_end - end) >> EFI_PAGE_SHIFT;
+			break;
+		}
+		next = efi_mem_next(mem);
+		efi_mem_remove(mem);
+		mem = next;
+	}
 }
 
 /**
@@ -268,11 +349,9 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 					  int memory_type,
 					  bool overlap_only_ram)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *newlist;
-	bool carve_again;
-	uint64_t carved_pages = 0;
+	struct efi_mem_list *newlist, *spare;
 	struct efi_event *evt;
+	u64 end;
 
 	EFI_PRINT("%s: 0x%llx 0x%llx %d %s\n", __func__,
 		  start, pages, memory_type, overlap_only_ram ? "yes" : "no");
@@ -283,10 +362,23 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 	if (!pages)
 		return EFI_SUCCESS;
 
+	end = start + (pages << EFI_PAGE_SHIFT);
+
+	/*
+	 * The payload wanted to have RAM overlaps, but the region overlaps
+	 * with an unallocated or non-RAM region. Error out.
+	 */
+	if (overlap_only_ram && !efi_mem_is_free(start, end))
+		return EFI_NO_MAPPING;
+
 	++efi_memory_map_key;
 	newlist = calloc(1, sizeof(*newlist));
-	if (!newlist)
+	spare = calloc(1, sizeof(*spare));
+	if (!newlist || !spare) {
+		free(newlist);
+		free(spare);
 		return EFI_OUT_OF_RESOURCES;
+	}
 	newlist->desc.type = memory_type;
 	newlist->desc.physical_start = start;
 	newlist->desc.virtual_start = start;
@@ -305,65 +397,11 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 		break;
 	}
 
-	/* Add our new map */
-	do {
-		carve_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			s64 r;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			r = efi_mem_carve_out(lmem, &newlist->desc,
-					      overlap_only_ram);
-			switch (r) {
-			case EFI_CARVE_OUT_OF_RESOURCES:
-				free(newlist);
-				return EFI_OUT_OF_RESOURCES;
-			case EFI_CARVE_OVERLAPS_NONRAM:
-				/*
-				 * The user requested to only have RAM overlaps,
-				 * but we hit a non-RAM region. Error out.
-				 */
-				free(newlist);
-				return EFI_NO_MAPPING;
-			case EFI_CARVE_NO_OVERLAP:
-				/* Just ignore this list entry */
-				break;
-			case EFI_CARVE_LOOP_AGAIN:
-				/*
-				 * We split an entry, but need to loop through
-				 * the list again to actually carve it.
-				 */
-				carve_again = true;
-				break;
-			default:
-				/* We carved a number of pages */
-				carved_pages += r;
-				carve_again = true;
-				break;
-			}
-
-			if (carve_again) {
-				/* The list changed, we need to start over */
-				break;
-			}
-		}
-	} while (carve_again);
-
-	if (overlap_only_ram && (carved_pages != pages)) {
-		/*
-		 * The payload wanted to have RAM overlaps, but we overlapped
-		 * with an unallocated region. Error out.
-		 */
-		free(newlist);
-		return EFI_NO_MAPPING;
-	}
-
-	/* Add our new map */
-        list_add_tail(&newlist->link, &efi_mem);
-
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	/* Remove the region from the map, then add our new map */
+	efi_mem_carve_out(start, end, &spare);
+	free(spare);
+	efi_mem_insert(newlist);
+	efi_mem_merge(newlist);
 
 	/* Notify that the memory map was changed */
 	list_for_each_entry(evt, &efi_events, link) {
@@ -417,34 +455,31 @@ efi_status_t efi_add_memory_map(u64 start, u64 size, int memory_type)
  */
 static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
 {
-	struct efi_mem_list *item;
-
-	list_for_each_entry(item, &efi_mem, link) {
-		u64 start = item->desc.physical_start;
-		u64 end = start + (item->desc.num_pages << EFI_PAGE_SHIFT);
-
-		if (addr >= start && addr < end) {
-			if (must_be_allocated ^
-			    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
-				return EFI_SUCCESS;
-			else
-				return EFI_NOT_FOUND;
-		}
-	}
+	struct efi_mem_list *item = efi_mem_find(addr);
+
+	if (!item || addr >= desc_get_end(&item->desc))
+		return EFI_NOT_FOUND;
 
-	return EFI_NOT_FOUND;
+	if (must_be_allocated ^ (item->desc.type == EFI_CONVENTIONAL_MEMORY))
+		return EFI_SUCCESS;
+	else
+		return EFI_NOT_FOUND;
 }
 
 /**
  * efi_find_free_memory() - find free memory pages
  *
+ * The free items are walked downwards starting with the highest one below
+ * @max_addr, so the highest suitable address is returned.
+ *
  * @len:	size of memory area needed
  * @max_addr:	highest address to allocate
  * Return:	pointer to free memory area or 0
  */
 static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 {
-	struct list_head *lhandle;
+	struct rb_node *node = efi_free_mem.rb_node;
+	struct rb_node *found = NULL;
 
 	/*
 	 * Prealign input max address, so we simplify our matching
@@ -452,33 +487,31 @@ static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
 	 */
 	max_addr &= ~EFI_PAGE_MASK;
 
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem = list_entry(lhandle,
-			struct efi_mem_list, link);
-		struct efi_mem_desc *desc = &lmem->desc;
-		uint64_t desc_len = desc->num_pages << EFI_PAGE_SHIFT;
-		uint64_t desc_end = desc->physical_start + desc_len;
-		uint64_t curmax = min(max_addr, desc_end);
-		uint64_t ret = curmax - len;
-
-		/* We only take memory from free RAM */
-		if (desc->type != EFI_CONVENTIONAL_MEMORY)
-			continue;
+	while (node) {
+		struct efi_mem_list *lmem;
 
-		/* Out of bounds for max_addr */
-		if ((ret + len) > max_addr)
-			continue;
+		lmem = rb_entry(node, struct efi_mem_list, free_node);
+		if (lmem->desc.physical_start < max_addr) {
+			found = node;
+			node = node->rb_right;
+		} else {
+			node = node->rb_left;
+		}
+	}
 
-		/* Out of bounds for upper map limit */
-		if ((ret + len) > desc_end)
-			continue;
+	for (node = found; node; node = rb_prev(node)) {
+		struct efi_mem_list *lmem = rb_entry(node,
+			struct efi_mem_list, free_node);
+		struct efi_mem_desc *desc = &lmem->desc;
+		uint64_t desc_end = desc_get_end(desc);
+		uint64_t curmax = min(max_addr, desc_end);
 
 		/* Out of bounds for lower map limit */
-		if (ret < desc->physical_start)
+		if (curmax - desc->physical_start < len)
 			continue;
 
 		/* Return the highest address in this map within bounds */
-		return ret;
+		return curmax - len;
 	}
 
 	return 0;
@@ -743,8 +776,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 				uint32_t *descriptor_version)
 {
 	efi_uintn_t map_size = 0;
-	int map_entries = 0;
-	struct list_head *lhandle;
+	struct rb_node *node;
 	efi_uintn_t provided_map_size;
 
 	if (!memory_map_size)
@@ -752,10 +784,7 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 
 	provided_map_size = *memory_map_size;
 
-	list_for_each(lhandle, &efi_mem)
-		map_entries++;
-
-	map_size = map_entries * sizeof(struct efi_mem_desc);
+	map_size = efi_mem_count * sizeof(struct efi_mem_desc);
 
 	*memory_map_size = map_size;
 
@@ -771,15 +800,12 @@ efi_status_t efi_get_memory_map(efi_uintn_t *memory_map_size,
 	if (!memory_map)
 		return EFI_INVALID_PARAMETER;
 
-	/* Copy list into array */
-	/* Return the list in ascending order */
-	memory_map = &memory_map[map_entries - 1];
-	list_for_each(lhandle, &efi_mem) {
+	/* Copy the tree into the array in ascending order */
+	for (node = rb_first(&efi_mem); node; node = rb_next(node)) {
 		struct efi_mem_list *lmem;
 
-		lmem = list_entry(lhandle, struct efi_mem_list, link);
-		*memory_map = lmem->desc;
-		memory_map--;
+		lmem = rb_entry(node, struct efi_mem_list, node);
+		*memory_map++ = lmem->desc;
 	}
 
 	if (map_key)
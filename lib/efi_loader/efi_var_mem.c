@@ -19,6 +19,102 @@
 static struct efi_var_file __efi_runtime_data *efi_var_buf;
 static struct efi_var_entry __efi_runtime_data *efi_current_var;
 
+/*
+ * Number of slots in the variable index. Each variable takes at least 40
+ * bytes of the buffer, so the index is never more than 80% full.
+ */
+#define EFI_VAR_INDEX_SLOTS	(EFI_VAR_BUF_SIZE / 32)
+
+/*
+ * The index is an open-addressed hash table mapping (GUID, name) to the
+ * offset of the variable in efi_var_buf, 0 marking an empty slot. Offsets
+ * are used instead of pointers so that only the table itself has to be
+ * converted by SetVirtualAddressMap().
+ */
+static u32 __efi_runtime_data *efi_var_index;
+static bool __efi_runtime_data efi_var_index_ok;
+
+/**
+ * efi_var_mem_hash() - calculate the index hash of a variable
+ *
+ * @guid:	vendor GUID
+ * @name:	variable name
+ * Return:	hash value
+ */
+static u32 __efi_runtime efi_var_mem_hash(const efi_guid_t *guid,
+					  const u16 *name)
+{
+	const u8 *p = (const u8 *)guid;
+	u32 hash = 2166136261u;
+	int i;
+
+	for (i = 0; i < sizeof(efi_guid_t); ++i)
+		hash = (hash ^ p[i]) * 16777619;
+	for (; *name; ++name)
+		hash = (hash ^ *name) * 16777619;
+
+	return hash;
+}
+
+/**
+ * efi_var_index_add() - add a variable to the index
+ *
+ * If the index is full it is marked as unusable and lookups fall back to
+ * scanning the buffer.
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_index_add(struct efi_var_entry *var)
+{
+	u32 slot, i;
+
+	if (!efi_var_index_ok)
+		return;
+
+	slot = efi_var_mem_hash(&var->guid, var->name) % EFI_VAR_INDEX_SLOTS;
+	for (i = 0; i < EFI_VAR_INDEX_SLOTS; ++i) {
+		if (!efi_var_index[slot]) {
+			efi_var_index[slot] = (uintptr_t)var -
+					      (uintptr_t)efi_var_buf;
+			return;
+		}
+		if (++slot == EFI_VAR_INDEX_SLOTS)
+			slot = 0;
+	}
+	efi_var_index_ok = false;
+}
+
+/**
+ * efi_var_index_rebuild() - rebuild the index from the variable buffer
+ *
+ * This is needed whenever variables move inside the buffer.
+ */
+static void __efi_runtime efi_var_index_rebuild(void)
+{
+	struct efi_var_entry *var, *last;
+	u16 *data;
+	u32 i;
+
+	if (!efi_var_index)
+		return;
+
+	/* memset() is not available at runtime */
+	for (i = 0; i < EFI_VAR_INDEX_SLOTS; ++i)
+		efi_var_index[i] = 0;
+	efi_var_index_ok = true;
+
+	last = (struct efi_var_entry *)
+	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	for (var = efi_var_buf->var; var < last;) {
+		efi_var_index_add(var);
+		for (data = var->name; *data; ++data)
+			;
+		++data;
+		var = (struct efi_var_entry *)
+		      ALIGN((uintptr_t)data + var->length, 8);
+	}
+}
+
 /**
  * efi_var_mem_compare() - compare GUID and name with a variable
  *
@@ -86,6 +182,29 @@ struct efi_var_entry __efi_runtime
 		return efi_current_var;
 	}
 
+	if (efi_var_index_ok) {
+		u32 slot, i;
+
+		slot = efi_var_mem_hash(guid, name) % EFI_VAR_INDEX_SLOTS;
+		for (i = 0; i < EFI_VAR_INDEX_SLOTS && efi_var_index[slot];
+		     ++i) {
+			struct efi_var_entry *pos;
+
+			var = (struct efi_var_entry *)
+			      ((uintptr_t)efi_var_buf + efi_var_index[slot]);
+			if (efi_var_mem_compare(var, guid, name, &pos)) {
+				if (next)
+					*next = pos < last ? pos : NULL;
+				return var;
+			}
+			if (++slot == EFI_VAR_INDEX_SLOTS)
+				slot = 0;
+		}
+		if (next)
+			*next = NULL;
+		return NULL;
+	}
+
 	var = efi_var_buf->var;
 	if (var < last) {
 		for (; var;) {
@@ -133,6 +252,8 @@ void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 	efi_var_buf->crc32 = crc32(0, (u8 *)efi_var_buf->var,
 				   efi_var_buf->length -
 				   sizeof(struct efi_var_file));
+	/* The variables following @var have moved */
+	efi_var_index_rebuild();
 }
 
 efi_status_t __efi_runtime efi_var_mem_ins(
@@ -164,6 +285,7 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 			   sizeof(u16) * var_name_len);
 	efi_memcpy_runtime(data, data1, size1);
 	efi_memcpy_runtime((u8 *)data + size1, data2, size2);
+	efi_var_index_add(var);
 
 	var = (struct efi_var_entry *)
 	      ALIGN((uintptr_t)data + var->length, 8);
@@ -242,6 +364,8 @@ static void EFIAPI __efi_runtime
 efi_var_mem_notify_virtual_address_map(struct efi_event *event, void *context)
 {
 	efi_convert_pointer(0, (void **)&efi_var_buf);
+	if (efi_var_index)
+		efi_convert_pointer(0, (void **)&efi_var_index);
 	efi_current_var = NULL;
 }
 
@@ -264,6 +388,16 @@ efi_status_t efi_var_mem_init(void)
 			      (uintptr_t)efi_var_buf;
 	/* crc32 for 0 bytes = 0 */
 
+	/* Without an index variables are found by scanning the buffer */
+	if (efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
+			       EFI_RUNTIME_SERVICES_DATA,
+			       efi_size_in_pages(EFI_VAR_INDEX_SLOTS *
+						 sizeof(*efi_var_index)),
+			       &memory) == EFI_SUCCESS) {
+		efi_var_index = (u32 *)(uintptr_t)memory;
+		efi_var_index_rebuild();
+	}
+
 	ret = efi_create_event(EVT_SIGNAL_EXIT_BOOT_SERVICES, TPL_CALLBACK,
 			       efi_var_mem_notify_exit_boot_services, NULL,
 			       NULL, &event);
@@ -348,10 +482,18 @@ efi_get_next_variable_name_mem(efi_uintn_t *variable_name_size,
 	efi_memcpy_runtime(variable_name, var->name, *variable_name_size);
 	efi_memcpy_runtime(vendor, &var->guid, sizeof(efi_guid_t));
 
+	/*
+	 * The caller will most likely pass this variable to the next call,
+	 * which then finds it in efi_var_mem_find() without a lookup.
+	 */
+	efi_current_var = var;
+
 	return EFI_SUCCESS;
 }
 
 void efi_var_buf_update(struct efi_var_file *var_buf)
 {
 	memcpy(efi_var_buf, var_buf, EFI_VAR_BUF_SIZE);
+	efi_current_var = NULL;
+	efi_var_index_rebuild();
 }
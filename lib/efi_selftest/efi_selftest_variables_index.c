@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * efi_selftest_variables_index
+ *
+ * This unit test checks that variables whose names collide in the index of
+ * the variable store can be created, deleted and created again, and that
+ * GetVariable() always agrees with enumerating the store with
+ * GetNextVariableName().
+ */
+
+#include <efi_selftest.h>
+
+#define EFI_ST_MAX_VARNAME_SIZE 40
+/* Number of variables sharing one slot of the index */
+#define EFI_ST_IDX_VARS 5
+/* Slots in the index, see EFI_VAR_INDEX_SLOTS in efi_var_mem.c */
+#define EFI_ST_IDX_SLOTS (CONFIG_EFI_VAR_BUF_SIZE / 32)
+
+static struct efi_runtime_services *runtime;
+static const efi_guid_t guid_vendor =
+	EFI_GUID(0x4b1f30a2, 0x6c5e, 0x4d8b,
+		 0x9e, 0x27, 0x81, 0x3a, 0xc4, 0x55, 0x0d, 0x6f);
+
+static u16 names[EFI_ST_IDX_VARS][EFI_ST_MAX_VARNAME_SIZE];
+/* Expected value of each variable, 0 if it should not exist */
+static u8 values[EFI_ST_IDX_VARS];
+
+/*
+ * Same hash as efi_var_mem_hash() in efi_var_mem.c
+ *
+ * @guid:	vendor GUID
+ * @name:	variable name
+ * Return:	hash value
+ */
+static u32 hash(const efi_guid_t *guid, const u16 *name)
+{
+	const u8 *p = (const u8 *)guid;
+	u32 hash = 2166136261u;
+	int i;
+
+	for (i = 0; i < sizeof(efi_guid_t); ++i)
+		hash = (hash ^ p[i]) * 16777619;
+	for (; *name; ++name)
+		hash = (hash ^ *name) * 16777619;
+
+	return hash;
+}
+
+/*
+ * Create the variable name "efi_st_idx<n>".
+ *
+ * @n:		number
+ * @name:	buffer for the name
+ */
+static void make_name(unsigned int n, u16 *name)
+{
+	const char *prefix = "efi_st_idx";
+	char digits[11];
+	int i = 0;
+
+	for (; *prefix; ++prefix)
+		*name++ = *prefix;
+	do {
+		digits[i++] = '0' + n % 10;
+		n /= 10;
+	} while (n);
+	while (i)
+		*name++ = digits[--i];
+	*name = 0;
+}
+
+static bool name_equal(const u16 *a, const u16 *b)
+{
+	for (; *a && *a == *b; ++a, ++b)
+		;
+
+	return *a == *b;
+}
+
+/*
+ * Set or delete variable @i and update its expected value.
+ *
+ * @i:		variable number
+ * @value:	new value, 0 to delete the variable
+ * Return:	status code
+ */
+static efi_status_t set(int i, u8 value)
+{
+	efi_status_t ret;
+
+	if (value)
+		ret = runtime->set_variable(names[i], &guid_vendor,
+					    EFI_VARIABLE_BOOTSERVICE_ACCESS,
+					    1, &value);
+	else
+		ret = runtime->set_variable(names[i], &guid_vendor, 0, 0,
+					    NULL);
+	values[i] = value;
+
+	return ret;
+}
+
+/*
+ * Check that GetVariable() finds exactly the variables which are enumerated
+ * by GetNextVariableName(), and that these are the expected ones.
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int check(void)
+{
+	u16 varname[EFI_ST_MAX_VARNAME_SIZE];
+	bool listed[EFI_ST_IDX_VARS] = {};
+	efi_uintn_t len;
+	efi_status_t ret;
+	efi_guid_t guid;
+	u32 attr;
+	u8 data;
+	int i;
+
+	memset(&guid, 0, sizeof(guid));
+	*varname = 0;
+	for (;;) {
+		len = sizeof(varname);
+		ret = runtime->get_next_variable_name(&len, varname, &guid);
+		if (ret == EFI_NOT_FOUND)
+			break;
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("GetNextVariableName failed (%u)\n",
+				     (unsigned int)ret);
+			return EFI_ST_FAILURE;
+		}
+		if (memcmp(&guid, &guid_vendor, sizeof(efi_guid_t)))
+			continue;
+		for (i = 0; i < EFI_ST_IDX_VARS; ++i) {
+			if (name_equal(varname, names[i]))
+				listed[i] = true;
+		}
+	}
+
+	for (i = 0; i < EFI_ST_IDX_VARS; ++i) {
+		if (listed[i] != !!values[i]) {
+			efi_st_error("Variable %ps %s enumerated\n", names[i],
+				     listed[i] ? "wrongly" : "not");
+			return EFI_ST_FAILURE;
+		}
+		len = sizeof(data);
+		data = 0;
+		ret = runtime->get_variable(names[i], &guid_vendor, &attr,
+					    &len, &data);
+		if (ret != (listed[i] ? EFI_SUCCESS : EFI_NOT_FOUND)) {
+			efi_st_error("GetVariable(%ps) disagrees with GetNextVariableName\n",
+				     names[i]);
+			return EFI_ST_FAILURE;
+		}
+		if (listed[i] && data != values[i]) {
+			efi_st_error("GetVariable(%ps) returned the wrong data\n",
+				     names[i]);
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/*
+ * Setup unit test.
+ *
+ * Find names which all fall into the same slot of the index.
+ *
+ * @handle	handle of the loaded image
+ * @systable	system table
+ */
+static int setup(const efi_handle_t img_handle,
+		 const struct efi_system_table *systable)
+{
+	unsigned int n;
+	u32 slot;
+	int found;
+
+	runtime = systable->runtime;
+
+	make_name(0, names[0]);
+	slot = hash(&guid_vendor, names[0]) % EFI_ST_IDX_SLOTS;
+	for (n = 1, found = 1; found < EFI_ST_IDX_VARS; ++n) {
+		make_name(n, names[found]);
+		if (hash(&guid_vendor, names[found]) % EFI_ST_IDX_SLOTS == slot)
+			++found;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/*
+ * Execute unit test.
+ */
+static int execute(void)
+{
+	int i;
+
+	/* Create all variables */
+	for (i = 0; i < EFI_ST_IDX_VARS; ++i) {
+		if (set(i, i + 1) != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	if (check() != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Delete the first and a middle one of the chain */
+	if (set(0, 0) != EFI_SUCCESS || set(2, 0) != EFI_SUCCESS) {
+		efi_st_error("SetVariable failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (check() != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Create them again, now at the end of the store */
+	if (set(2, 0x33) != EFI_SUCCESS || set(0, 0x11) != EFI_SUCCESS) {
+		efi_st_error("SetVariable failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (check() != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Change one value, which replaces the variable */
+	if (set(EFI_ST_IDX_VARS - 1, 0x55) != EFI_SUCCESS) {
+		efi_st_error("SetVariable failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (check() != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Delete all of them */
+	for (i = 0; i < EFI_ST_IDX_VARS; ++i) {
+		if (set(i, 0) != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return check();
+}
+
+EFI_UNIT_TEST(variables_index) = {
+	.name = "variable index",
+	.phase = EFI_EXECUTE_BEFORE_BOOTTIME_EXIT,
+	.setup = setup,
+	.execute = execute,
+};
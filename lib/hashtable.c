@@ -790,12 +790,74 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
  * '\0' and '\n' have really been tested.
  */
 
+/* Return the table index of an entry returned by hsearch_r() */
+static int htab_entry_idx(struct hsearch_data *htab, struct env_entry *ep)
+{
+	struct env_entry_node *node;
+
+	node = (struct env_entry_node *)((char *)ep -
+					 offsetof(struct env_entry_node, entry));
+
+	return node - htab->table;
+}
+
+/*
+ * himport_diff_seen()
+ *
+ * In H_DIFF mode, look up @name and record its slot in @seen so that a
+ * full import can later drop the variables it did not mention. The slot is
+ * recorded before the new value is entered, so a variable whose update is
+ * rejected (e.g. a write-once one) is still kept. Returns 1 if the variable
+ * already holds @value and nothing needs to be done.
+ */
+static int himport_diff_seen(struct hsearch_data *htab, unsigned char *seen,
+			     char *name, const char *value)
+{
+	struct env_entry e, *ep;
+
+	e.key = name;
+	e.data = NULL;
+	if (!hsearch_r(e, ENV_FIND, &ep, htab, 0))
+		return 0;
+	if (seen)
+		seen[htab_entry_idx(htab, ep)] = 1;
+
+	return !strcmp(ep->data, value);
+}
+
+/*
+ * himport_diff_drop()
+ *
+ * Delete all variables which were not part of a full H_DIFF import. The
+ * variables to drop are determined up front, so that variables created by
+ * callbacks while deleting are left alone. The deletes go through
+ * change_ok() like any other, so protected variables are kept.
+ */
+static void himport_diff_drop(struct hsearch_data *htab, unsigned char *seen,
+			      int flag)
+{
+	int i;
+
+	for (i = 1; i <= htab->size; i++) {
+		if (htab->table[i].used > 0 && !seen[i])
+			seen[i] = 2;
+	}
+	for (i = 1; i <= htab->size; i++) {
+		if (seen[i] != 2 || htab->table[i].used <= 0)
+			continue;
+		debug("DIFF: drop \"%s\"\n", htab->table[i].entry.key);
+		if (hdelete_r(htab->table[i].entry.key, htab, flag))
+			debug("DELETE ERROR ##############################\n");
+	}
+}
+
 int himport_r(struct hsearch_data *htab,
 		const char *env, size_t size, const char sep, int flag,
 		int crlf_is_lf, int nvars, char * const vars[])
 {
 	char *data, *sp, *dp, *name, *value;
 	char *localvars[nvars];
+	unsigned char *seen = NULL;
 	int i;
 
 	/* Test for correct arguments.  */
@@ -822,7 +884,16 @@ int himport_r(struct hsearch_data *htab,
 	flag |= H_NOCLEAR;
 #endif
 
-	if ((flag & H_NOCLEAR) == 0 && !nvars) {
+	if ((flag & H_NOCLEAR) == 0 && !nvars && (flag & H_DIFF) &&
+	    htab->table) {
+		/* Keep the table; drop what the import does not mention */
+		seen = calloc(htab->size + 1, 1);
+		if (!seen) {
+			free(data);
+			__set_errno(ENOMEM);
+			return 0;
+		}
+	} else if ((flag & H_NOCLEAR) == 0 && !nvars) {
 		/* Destroy old hash table if one exists */
 		debug("Destroy Hash Table: %p table = %p\n", htab,
 		       htab->table);
@@ -863,6 +934,9 @@ int himport_r(struct hsearch_data *htab,
 	}
 
 	if (!size) {
+		if (seen)
+			himport_diff_drop(htab, seen, flag);
+		free(seen);
 		free(data);
 		return 1;		/* everything OK */
 	}
@@ -929,6 +1003,7 @@ int himport_r(struct hsearch_data *htab,
 		if (*name == 0) {
 			debug("INSERT: unable to use an empty key\n");
 			__set_errno(EINVAL);
+			free(seen);
 			free(data);
 			return 0;
 		}
@@ -937,11 +1012,20 @@ int himport_r(struct hsearch_data *htab,
 		if (!drop_var_from_set(name, nvars, localvars))
 			continue;
 
+		/* Leave unchanged variables (and their callbacks) alone */
+		if ((flag & H_DIFF) &&
+		    himport_diff_seen(htab, seen, name, value)) {
+			debug("UNCHANGED: \"%s\"\n", name);
+			continue;
+		}
+
 		/* enter into hash table */
 		e.key = name;
 		e.data = value;
 
 		hsearch_r(e, ENV_ENTER, &rv, htab, flag);
+		if (seen && rv)
+			seen[htab_entry_idx(htab, rv)] = 1;
 #if !IS_ENABLED(CONFIG_ENV_WRITEABLE_LIST)
 		if (rv == NULL) {
 			printf("himport_r: can't insert \"%s=%s\" into hash table\n",
@@ -957,6 +1041,11 @@ int himport_r(struct hsearch_data *htab,
 	debug("INSERT: free(data = %p)\n", data);
 	free(data);
 
+	if (seen) {
+		himport_diff_drop(htab, seen, flag);
+		free(seen);
+	}
+
 	if (flag & H_NOCLEAR)
 		goto end;
 
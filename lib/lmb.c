@@ -96,14 +96,74 @@ static long lmb_regions_adjacent(struct lmb_region *rgn, unsigned long r1,
 
 static void lmb_remove_region(struct lmb_region *rgn, unsigned long r)
 {
-	unsigned long i;
+	memmove(&rgn->region[r], &rgn->region[r + 1],
+		(rgn->cnt - r - 1) * sizeof(rgn->region[0]));
+	rgn->cnt--;
+}
+
+/**
+ * lmb_search_end() - find the first region which ends at or above an address
+ *
+ * The regions are kept sorted by base address and do not overlap, so their
+ * end addresses are sorted as well.
+ *
+ * @rgn:	set of regions to search
+ * @addr:	address to look for
+ * Return:	index of the first region whose last byte is at or above @addr,
+ *		rgn->cnt if there is none
+ */
+static unsigned long lmb_search_end(struct lmb_region *rgn, phys_addr_t addr)
+{
+	unsigned long lo = 0, hi = rgn->cnt;
 
-	for (i = r; i < rgn->cnt - 1; i++) {
-		rgn->region[i].base = rgn->region[i + 1].base;
-		rgn->region[i].size = rgn->region[i + 1].size;
-		rgn->region[i].flags = rgn->region[i + 1].flags;
+	while (lo < hi) {
+		unsigned long mid = lo + (hi - lo) / 2;
+		phys_addr_t end = rgn->region[mid].base +
+				  rgn->region[mid].size - 1;
+
+		if (end < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-	rgn->cnt--;
+
+	return lo;
+}
+
+/**
+ * lmb_grow_region() - make room for more regions
+ *
+ * Without CONFIG_LMB_USE_MAX_REGIONS the configured number of regions is
+ * only the initial size. When it is used up the array is moved to the heap
+ * and doubled in size.
+ *
+ * @rgn:	set of regions to grow
+ * Return:	0 if OK, -1 if there is no more space
+ */
+static int lmb_grow_region(struct lmb_region *rgn)
+{
+#if IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
+	return -1;
+#else
+	unsigned long max = rgn->max * 2;
+	struct lmb_property *region;
+
+	if (rgn->heap) {
+		region = realloc(rgn->region, max * sizeof(*region));
+		if (!region)
+			return -1;
+	} else {
+		region = malloc(max * sizeof(*region));
+		if (!region)
+			return -1;
+		memcpy(region, rgn->region, rgn->cnt * sizeof(*region));
+		rgn->heap = true;
+	}
+	rgn->region = region;
+	rgn->max = max;
+
+	return 0;
+#endif
 }
 
 /* Assumption: base addr of region 1 < base addr of region 2 */
@@ -141,11 +201,24 @@ void lmb_init(struct lmb *lmb)
 	lmb->reserved.max = CONFIG_LMB_RESERVED_REGIONS;
 	lmb->memory.region = lmb->memory_regions;
 	lmb->reserved.region = lmb->reserved_regions;
+	lmb->memory.heap = false;
+	lmb->reserved.heap = false;
 #endif
 	lmb->memory.cnt = 0;
 	lmb->reserved.cnt = 0;
 }
 
+void lmb_uninit(struct lmb *lmb)
+{
+#if !IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
+	if (lmb->memory.heap)
+		free(lmb->memory.region);
+	if (lmb->reserved.heap)
+		free(lmb->reserved.region);
+#endif
+	lmb_init(lmb);
+}
+
 void arch_lmb_reserve_generic(struct lmb *lmb, ulong sp, ulong end, ulong align)
 {
 	ulong bank_end;
@@ -258,6 +331,7 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 				 phys_size_t size, enum lmb_flags flags)
 {
 	unsigned long coalesced = 0;
+	unsigned long lo, hi;
 	long adjacent, i;
 
 	if (rgn->cnt == 0) {
@@ -268,13 +342,23 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 		return 0;
 	}
 
-	/* First try and coalesce this LMB with another. */
-	for (i = 0; i < rgn->cnt; i++) {
+	/*
+	 * First try and coalesce this LMB with another. Regions ending more
+	 * than one byte below @base cannot touch it, so skip them.
+	 */
+	i = base ? lmb_search_end(rgn, base - 1) : 0;
+	for (; i < rgn->cnt; i++) {
 		phys_addr_t rgnbase = rgn->region[i].base;
 		phys_size_t rgnsize = rgn->region[i].size;
 		phys_size_t rgnflags = rgn->region[i].flags;
 		phys_addr_t end = base + size - 1;
 		phys_addr_t rgnend = rgnbase + rgnsize - 1;
+
+		/* Neither this nor any later region can touch the new one */
+		if (end + 1 > end && rgnbase > end + 1) {
+			i = rgn->cnt;
+			break;
+		}
 		if (rgnbase <= base && end <= rgnend) {
 			if (flags == rgnflags)
 				/* Already have this region, so we're done */
@@ -292,6 +376,19 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 			coalesced++;
 			break;
 		} else if (adjacent < 0) {
+			/*
+			 * Don't let the new region grow into the next one,
+			 * unless they can be merged below.
+			 */
+			if (i + 1 < rgn->cnt &&
+			    lmb_addrs_overlap(base, size,
+					      rgn->region[i + 1].base,
+					      rgn->region[i + 1].size) &&
+			    (flags != rgnflags ||
+			     flags != rgn->region[i + 1].flags ||
+			     end >= rgn->region[i + 1].base +
+				    rgn->region[i + 1].size))
+				return -1;
 			if (flags != rgnflags)
 				break;
 			rgn->region[i].size += size;
@@ -316,28 +413,28 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 
 	if (coalesced)
 		return coalesced;
-	if (rgn->cnt >= rgn->max)
+	if (rgn->cnt >= rgn->max && lmb_grow_region(rgn))
 		return -1;
 
-	/* Couldn't coalesce the LMB, so add it to the sorted table. */
-	for (i = rgn->cnt-1; i >= 0; i--) {
-		if (base < rgn->region[i].base) {
-			rgn->region[i + 1].base = rgn->region[i].base;
-			rgn->region[i + 1].size = rgn->region[i].size;
-			rgn->region[i + 1].flags = rgn->region[i].flags;
-		} else {
-			rgn->region[i + 1].base = base;
-			rgn->region[i + 1].size = size;
-			rgn->region[i + 1].flags = flags;
-			break;
-		}
-	}
-
-	if (base < rgn->region[0].base) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
-		rgn->region[0].flags = flags;
+	/*
+	 * Couldn't coalesce the LMB, so add it to the sorted table, after
+	 * any region with the same base.
+	 */
+	lo = 0;
+	hi = rgn->cnt;
+	while (lo < hi) {
+		unsigned long mid = lo + (hi - lo) / 2;
+
+		if (rgn->region[mid].base <= base)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+	memmove(&rgn->region[lo + 1], &rgn->region[lo],
+		(rgn->cnt - lo) * sizeof(rgn->region[0]));
+	rgn->region[lo].base = base;
+	rgn->region[lo].size = size;
+	rgn->region[lo].flags = flags;
 
 	rgn->cnt++;
 
@@ -368,16 +465,14 @@ long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 	rgnbegin = rgnend = 0; /* supress gcc warnings */
 
 	/* Find the region where (base, size) belongs to */
-	for (i = 0; i < rgn->cnt; i++) {
+	i = lmb_search_end(rgn, end);
+	if (i < rgn->cnt) {
 		rgnbegin = rgn->region[i].base;
 		rgnend = rgnbegin + rgn->region[i].size - 1;
-
-		if ((rgnbegin <= base) && (end <= rgnend))
-			break;
 	}
 
 	/* Didn't find the region */
-	if (i == rgn->cnt)
+	if (i == rgn->cnt || rgnbegin > base)
 		return -1;
 
 	/* Check to see if we are removing entire region */
@@ -424,16 +519,13 @@ long lmb_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 static long lmb_overlaps_region(struct lmb_region *rgn, phys_addr_t base,
 				phys_size_t size)
 {
-	unsigned long i;
+	unsigned long i = lmb_search_end(rgn, base);
 
-	for (i = 0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
-		if (lmb_addrs_overlap(base, size, rgnbase, rgnsize))
-			break;
-	}
+	if (i < rgn->cnt && lmb_addrs_overlap(base, size, rgn->region[i].base,
+					      rgn->region[i].size))
+		return i;
 
-	return (i < rgn->cnt) ? i : -1;
+	return -1;
 }
 
 phys_addr_t lmb_alloc(struct lmb *lmb, phys_size_t size, ulong align)
@@ -535,16 +627,14 @@ phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
 	/* check if the requested address is in the memory regions */
 	rgn = lmb_overlaps_region(&lmb->memory, addr, 1);
 	if (rgn >= 0) {
-		for (i = 0; i < lmb->reserved.cnt; i++) {
+		i = lmb_search_end(&lmb->reserved, addr);
+		if (i < lmb->reserved.cnt) {
 			if (addr < lmb->reserved.region[i].base) {
 				/* first reserved range > requested address */
 				return lmb->reserved.region[i].base - addr;
 			}
-			if (lmb->reserved.region[i].base +
-			    lmb->reserved.region[i].size > addr) {
-				/* requested addr is in this reserved range */
-				return 0;
-			}
+			/* requested addr is in this reserved range */
+			return 0;
 		}
 		/* if we come here: no reserved ranges above requested addr */
 		return lmb->memory.region[lmb->memory.cnt - 1].base +
@@ -555,14 +645,11 @@ phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
 
 int lmb_is_reserved_flags(struct lmb *lmb, phys_addr_t addr, int flags)
 {
-	int i;
+	unsigned long i = lmb_search_end(&lmb->reserved, addr);
+
+	if (i < lmb->reserved.cnt && addr >= lmb->reserved.region[i].base)
+		return (lmb->reserved.region[i].flags & flags) == flags;
 
-	for (i = 0; i < lmb->reserved.cnt; i++) {
-		phys_addr_t upper = lmb->reserved.region[i].base +
-			lmb->reserved.region[i].size - 1;
-		if ((addr >= lmb->reserved.region[i].base) && (addr <= upper))
-			return (lmb->reserved.region[i].flags & flags) == flags;
-	}
 	return 0;
 }
 
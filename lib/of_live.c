@@ -24,6 +24,9 @@ enum {
 	BUF_STEP	= SZ_64K,
 };
 
+/* Depth of the node being unflattened, reset before each pass */
+static int depth;
+
 static void *unflatten_dt_alloc(void **mem, unsigned long size,
 				unsigned long align)
 {
@@ -40,15 +43,16 @@ static void *unflatten_dt_alloc(void **mem, unsigned long size,
  * unflatten_dt_node() - Alloc and populate a device_node from the flat tree
  * @blob: The parent device tree blob
  * @mem: Memory chunk to use for allocating device nodes and properties
+ * @mem_end: End of the memory chunk; if it would be overrun, NULL is returned
  * @poffset: pointer to node in flat tree
  * @dad: Parent struct device_node
  * @nodepp: The device_node tree created by the call
- * @fpsize: Size of the node path up at t05he current depth.
+ * @fpsize: Size of the node path up at the current depth.
  * @dryrun: If true, do not allocate device nodes but still calculate needed
  * memory size
  */
-static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
-			       struct device_node *dad,
+static void *unflatten_dt_node(const void *blob, void *mem, void *mem_end,
+			       int *poffset, struct device_node *dad,
 			       struct device_node **nodepp,
 			       unsigned long fpsize, bool dryrun)
 {
@@ -58,7 +62,6 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	const char *pathp;
 	int l;
 	unsigned int allocl;
-	static int depth;
 	int old_depth;
 	int offset;
 	int has_name = 0;
@@ -101,6 +104,8 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 
 	np = unflatten_dt_alloc(&mem, sizeof(struct device_node) + allocl,
 				__alignof__(struct device_node));
+	if (!dryrun && mem > mem_end)
+		return NULL;
 	if (!dryrun) {
 		char *fn;
 
@@ -155,6 +160,8 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 			has_name = 1;
 		pp = unflatten_dt_alloc(&mem, sizeof(struct property),
 					__alignof__(struct property));
+		if (!dryrun && mem > mem_end)
+			return NULL;
 		if (!dryrun) {
 			/*
 			 * We accept flattened tree phandles either in
@@ -200,6 +207,8 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		sz = (pa - ps) + 1;
 		pp = unflatten_dt_alloc(&mem, sizeof(struct property) + sz,
 					__alignof__(struct property));
+		if (!dryrun && mem > mem_end)
+			return NULL;
 		if (!dryrun) {
 			pp->name = "name";
 			pp->length = sz;
@@ -228,7 +237,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	if (depth < 0)
 		depth = 0;
 	while (*poffset > 0 && depth > old_depth) {
-		mem = unflatten_dt_node(blob, mem, poffset, np, NULL,
+		mem = unflatten_dt_node(blob, mem, mem_end, poffset, np, NULL,
 					fpsize, dryrun);
 		if (!mem)
 			return NULL;
@@ -286,8 +295,9 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 
 	/* First pass, scan for size */
 	start = 0;
-	size = (unsigned long)unflatten_dt_node(blob, NULL, &start, NULL, NULL,
-						0, true);
+	depth = 0;
+	size = (unsigned long)unflatten_dt_node(blob, NULL, NULL, &start, NULL,
+						NULL, 0, true);
 	if (!size)
 		return -EFAULT;
 	size = ALIGN(size, 4);
@@ -296,6 +306,8 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 
 	/* Allocate memory for the expanded device tree */
 	mem = memalign(__alignof__(struct device_node), size + 4);
+	if (!mem)
+		return -ENOMEM;
 	memset(mem, '\0', size);
 
 	/* Set up value for dm_test_livetree_align() */
@@ -307,8 +319,10 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 
 	/* Second pass, do actual unflattening */
 	start = 0;
-	unflatten_dt_node(blob, mem, &start, NULL, mynodes, 0, false);
-	if (be32_to_cpup(mem + size) != 0xdeadbeef) {
+	depth = 0;
+	if (!unflatten_dt_node(blob, mem, mem + size, &start, NULL, mynodes, 0,
+			       false) ||
+	    be32_to_cpup(mem + size) != 0xdeadbeef) {
 		debug("End of tree marker overwritten: %08x\n",
 		      be32_to_cpup(mem + size));
 		return -ENOSPC;
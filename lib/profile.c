@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler
+ */
+
+#include <common.h>
+#include <kallsyms.h>
+#include <malloc.h>
+#include <profile.h>
+#include <sort.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct profile_info - State of the profiler
+ *
+ * @samples: Sampled addresses, adjusted to link-time addresses
+ * @count: Number of samples recorded
+ * @dropped: Number of samples lost because the buffer was full
+ * @period_us: Sampling period in microseconds
+ * @running: true if samples are being collected
+ */
+struct profile_info {
+	ulong *samples;
+	uint count;
+	uint dropped;
+	ulong period_us;
+	bool running;
+};
+
+/**
+ * struct profile_func - Samples attributed to one function
+ *
+ * @name: Function name, or NULL if unknown
+ * @addr: Start address of the function (or the sampled address if unknown)
+ * @hits: Number of samples
+ */
+struct profile_func {
+	const char *name;
+	ulong addr;
+	uint hits;
+};
+
+static struct profile_info profile;
+
+__weak int arch_profile_start(ulong period_us)
+{
+	return -ENOSYS;
+}
+
+__weak void arch_profile_stop(void)
+{
+}
+
+void profile_sample(ulong pc)
+{
+	struct profile_info *prof = &profile;
+
+	if (!prof->running)
+		return;
+	if (prof->count < CONFIG_PROFILE_SAMPLES)
+		prof->samples[prof->count++] = pc - gd->reloc_off;
+	else
+		prof->dropped++;
+}
+
+int profile_start(ulong period_us)
+{
+	struct profile_info *prof = &profile;
+	int ret;
+
+	profile_stop();
+	if (!prof->samples) {
+		prof->samples = malloc(CONFIG_PROFILE_SAMPLES *
+				       sizeof(*prof->samples));
+		if (!prof->samples)
+			return -ENOMEM;
+	}
+	prof->count = 0;
+	prof->dropped = 0;
+	prof->period_us = period_us;
+	prof->running = true;
+
+	ret = arch_profile_start(period_us);
+	if (ret) {
+		prof->running = false;
+		return ret;
+	}
+
+	return 0;
+}
+
+void profile_stop(void)
+{
+	struct profile_info *prof = &profile;
+
+	if (!prof->running)
+		return;
+	arch_profile_stop();
+	prof->running = false;
+}
+
+static int h_cmp_addr(const void *v1, const void *v2)
+{
+	const ulong *a1 = v1, *a2 = v2;
+
+	return *a1 < *a2 ? -1 : *a1 > *a2;
+}
+
+static int h_cmp_hits(const void *v1, const void *v2)
+{
+	const struct profile_func *f1 = v1, *f2 = v2;
+
+	if (f1->hits != f2->hits)
+		return f1->hits < f2->hits ? 1 : -1;
+
+	return f1->addr < f2->addr ? -1 : f1->addr > f2->addr;
+}
+
+/**
+ * profile_bucket() - Attribute the sorted samples to functions
+ *
+ * Since the samples are sorted, each symbol is only looked up once, when the
+ * first sample beyond the end of the previous symbol is reached.
+ *
+ * @prof: Profiler state, with samples sorted by address
+ * @funcs: Returns the functions, which must have space for all the samples
+ * Return: number of functions found
+ */
+static uint profile_bucket(struct profile_info *prof,
+			   struct profile_func *funcs)
+{
+	struct profile_func *func = NULL;
+	ulong base = 0, end = 0;
+	const char *name = NULL;
+	uint i, nfuncs = 0;
+
+	for (i = 0; i < prof->count; i++) {
+		ulong pc = prof->samples[i];
+
+		if (!IS_ENABLED(CONFIG_KALLSYMS)) {
+			/* without a symbol table, each address is a bucket */
+			base = pc;
+			end = pc + 1;
+		} else if (!func || pc >= end) {
+			name = symbol_lookup_range(pc, &base, &end);
+			if (!name)
+				base = 0;
+		}
+		if (!func || func->addr != base) {
+			func = &funcs[nfuncs++];
+			func->name = name;
+			func->addr = base;
+			func->hits = 0;
+		}
+		func->hits++;
+	}
+
+	return nfuncs;
+}
+
+int profile_show(uint max_funcs)
+{
+	struct profile_info *prof = &profile;
+	struct profile_func *funcs;
+	uint nfuncs, i;
+
+	if (prof->running)
+		return -EBUSY;
+	printf("%u samples, %u dropped, period %lu us\n", prof->count,
+	       prof->dropped, prof->period_us);
+	if (!prof->count)
+		return 0;
+
+	funcs = malloc(prof->count * sizeof(*funcs));
+	if (!funcs)
+		return -ENOMEM;
+	qsort(prof->samples, prof->count, sizeof(*prof->samples), h_cmp_addr);
+	nfuncs = profile_bucket(prof, funcs);
+	qsort(funcs, nfuncs, sizeof(*funcs), h_cmp_hits);
+
+	printf("%8s %6s  %-16s %s\n", "Samples", "%", "Address", "Function");
+	for (i = 0; i < min(nfuncs, max_funcs); i++) {
+		struct profile_func *func = &funcs[i];
+		uint permille = (u64)func->hits * 1000 / prof->count;
+
+		printf("%8u %4u.%u  %016lx %s\n", func->hits, permille / 10,
+		       permille % 10, func->addr, func->name ?: "?");
+	}
+	free(funcs);
+
+	return 0;
+}
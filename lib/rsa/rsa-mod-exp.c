@@ -36,21 +36,135 @@ static inline uint64_t fdt64_to_cpup(const void *p)
 /* Default public exponent for backward compatibility */
 #define RSA_DEFAULT_PUBEXP	65537
 
+/*
+ * Numbers are held as little-endian arrays of limbs. Where the compiler has a
+ * 128-bit type (e.g. RV64, arm64 and x86_64) the limbs are 64 bits, so that a
+ * Montgomery multiply needs a quarter of the multiply-add steps.
+ */
+#ifdef __SIZEOF_INT128__
+typedef uint64_t rsa_limb;
+typedef unsigned __int128 rsa_dlimb;
+#else
+typedef uint32_t rsa_limb;
+typedef uint64_t rsa_dlimb;
+#endif
+
+#define LIMB_BITS	(sizeof(rsa_limb) * 8)
+#define LIMB_WORDS	(sizeof(rsa_limb) / sizeof(uint32_t))
+#define RSA_MAX_LIMBS	(RSA_MAX_KEY_BITS / LIMB_BITS)
+
+/* Exponents longer than this use a sliding window, see pow_mod() */
+#define RSA_WINDOW_MIN_BITS	20
+#define RSA_WINDOW_BITS		4
+
+/**
+ * struct mont_key - An RSA public key, ready for Montgomery multiplication
+ *
+ * If the key has an odd number of 32-bit words and the limbs are 64 bits,
+ * the top limb is padded with zeroes. Then R (2^(number of limb bits)) is
+ * 2^32 times the R used to work out the R^2 value given with the key. This
+ * is corrected for in pow_mod().
+ *
+ * @len:	Number of limbs
+ * @len32:	Number of 32-bit words in the key
+ * @n0inv:	-1 / modulus[0] mod 2^LIMB_BITS
+ * @exponent:	Public exponent
+ * @modulus:	Modulus
+ * @rr:		R^2 mod modulus, with R = 2^(32 * @len32)
+ */
+struct mont_key {
+	uint len;
+	uint len32;
+	rsa_limb n0inv;
+	uint64_t exponent;
+	rsa_limb modulus[RSA_MAX_LIMBS];
+	rsa_limb rr[RSA_MAX_LIMBS];
+};
+
+/**
+ * words_to_limbs() - Convert a little-endian word array to limbs
+ *
+ * @dst:	Returns the limbs
+ * @nlimbs:	Number of limbs to fill in
+ * @src:	Little-endian array of 32-bit words
+ * @len32:	Number of words in @src
+ */
+static void words_to_limbs(rsa_limb dst[], uint nlimbs, const uint32_t src[],
+			   uint len32)
+{
+	uint i, j;
+
+	for (i = 0; i < nlimbs; i++) {
+		dst[i] = 0;
+		for (j = 0; j < LIMB_WORDS && i * LIMB_WORDS + j < len32; j++)
+			dst[i] |= (rsa_limb)src[i * LIMB_WORDS + j] << (32 * j);
+	}
+}
+
+/**
+ * limbs_to_words() - Convert limbs to a little-endian word array
+ *
+ * @dst:	Returns the little-endian array of 32-bit words
+ * @len32:	Number of words to fill in
+ * @src:	Limbs to convert
+ */
+static void limbs_to_words(uint32_t dst[], uint len32, const rsa_limb src[])
+{
+	uint i;
+
+	for (i = 0; i < len32; i++)
+		dst[i] = (uint32_t)(src[i / LIMB_WORDS] >>
+				    (32 * (i % LIMB_WORDS)));
+}
+
+/**
+ * mont_key_init() - Set up a key for Montgomery multiplication
+ *
+ * @key:	Returns the key
+ * @modulus:	Modulus as little endian word array
+ * @rr:		R^2 as little endian word array
+ * @len32:	Number of words in @modulus and @rr
+ * @exponent:	Public exponent
+ */
+static void mont_key_init(struct mont_key *key, const uint32_t *modulus,
+			  const uint32_t *rr, uint len32, uint64_t exponent)
+{
+	rsa_limb inv;
+	int i;
+
+	key->len32 = len32;
+	key->len = (len32 + LIMB_WORDS - 1) / LIMB_WORDS;
+	key->exponent = exponent;
+	words_to_limbs(key->modulus, key->len, modulus, len32);
+	words_to_limbs(key->rr, key->len, rr, len32);
+
+	/*
+	 * The n0-inverse stored with the key is only 32 bits, so work it out
+	 * from the modulus. Since the modulus is odd it is its own inverse
+	 * mod 8 and each Newton step doubles the number of correct bits.
+	 */
+	inv = key->modulus[0];
+	for (i = 0; i < 5; i++)
+		inv *= 2 - key->modulus[0] * inv;
+	key->n0inv = -inv;
+}
+
 /**
  * subtract_modulus() - subtract modulus from the given value
  *
  * @key:	Key containing modulus to subtract
- * @num:	Number to subtract modulus from, as little endian word array
+ * @num:	Number to subtract modulus from, as little endian limb array
  */
-static void subtract_modulus(const struct rsa_public_key *key, uint32_t num[])
+static void subtract_modulus(const struct mont_key *key, rsa_limb num[])
 {
-	int64_t acc = 0;
+	rsa_limb borrow = 0;
+	rsa_dlimb acc;
 	uint i;
 
 	for (i = 0; i < key->len; i++) {
-		acc += (uint64_t)num[i] - key->modulus[i];
-		num[i] = (uint32_t)acc;
-		acc >>= 32;
+		acc = (rsa_dlimb)num[i] - key->modulus[i] - borrow;
+		num[i] = (rsa_limb)acc;
+		borrow = (rsa_limb)(acc >> LIMB_BITS) & 1;
 	}
 }
 
@@ -58,11 +172,11 @@ static void subtract_modulus(const struct rsa_public_key *key, uint32_t num[])
  * greater_equal_modulus() - check if a value is >= modulus
  *
  * @key:	Key containing modulus to check
- * @num:	Number to check against modulus, as little endian word array
+ * @num:	Number to check against modulus, as little endian limb array
  * Return: 0 if num < modulus, 1 if num >= modulus
  */
-static int greater_equal_modulus(const struct rsa_public_key *key,
-				 uint32_t num[])
+static int greater_equal_modulus(const struct mont_key *key,
+				 const rsa_limb num[])
 {
 	int i;
 
@@ -82,32 +196,32 @@ static int greater_equal_modulus(const struct rsa_public_key *key,
  * Operation: montgomery result[] += a * b[] / n0inv % modulus
  *
  * @key:	RSA key
- * @result:	Place to put result, as little endian word array
+ * @result:	Place to put result, as little endian limb array
  * @a:		Multiplier
- * @b:		Multiplicand, as little endian word array
+ * @b:		Multiplicand, as little endian limb array
  */
-static void montgomery_mul_add_step(const struct rsa_public_key *key,
-		uint32_t result[], const uint32_t a, const uint32_t b[])
+static void montgomery_mul_add_step(const struct mont_key *key,
+		rsa_limb result[], const rsa_limb a, const rsa_limb b[])
 {
-	uint64_t acc_a, acc_b;
-	uint32_t d0;
+	rsa_dlimb acc_a, acc_b;
+	rsa_limb d0;
 	uint i;
 
-	acc_a = (uint64_t)a * b[0] + result[0];
-	d0 = (uint32_t)acc_a * key->n0inv;
-	acc_b = (uint64_t)d0 * key->modulus[0] + (uint32_t)acc_a;
+	acc_a = (rsa_dlimb)a * b[0] + result[0];
+	d0 = (rsa_limb)acc_a * key->n0inv;
+	acc_b = (rsa_dlimb)d0 * key->modulus[0] + (rsa_limb)acc_a;
 	for (i = 1; i < key->len; i++) {
-		acc_a = (acc_a >> 32) + (uint64_t)a * b[i] + result[i];
-		acc_b = (acc_b >> 32) + (uint64_t)d0 * key->modulus[i] +
-				(uint32_t)acc_a;
-		result[i - 1] = (uint32_t)acc_b;
+		acc_a = (acc_a >> LIMB_BITS) + (rsa_dlimb)a * b[i] + result[i];
+		acc_b = (acc_b >> LIMB_BITS) +
+			(rsa_dlimb)d0 * key->modulus[i] + (rsa_limb)acc_a;
+		result[i - 1] = (rsa_limb)acc_b;
 	}
 
-	acc_a = (acc_a >> 32) + (acc_b >> 32);
+	acc_a = (acc_a >> LIMB_BITS) + (acc_b >> LIMB_BITS);
 
-	result[i - 1] = (uint32_t)acc_a;
+	result[i - 1] = (rsa_limb)acc_a;
 
-	if (acc_a >> 32)
+	if (acc_a >> LIMB_BITS)
 		subtract_modulus(key, result);
 }
 
@@ -117,12 +231,13 @@ static void montgomery_mul_add_step(const struct rsa_public_key *key,
  * Operation: montgomery result[] = a[] * b[] / n0inv % modulus
  *
  * @key:	RSA key
- * @result:	Place to put result, as little endian word array
- * @a:		Multiplier, as little endian word array
- * @b:		Multiplicand, as little endian word array
+ * @result:	Place to put result, as little endian limb array. This must
+ *		not be the same as @a or @b
+ * @a:		Multiplier, as little endian limb array
+ * @b:		Multiplicand, as little endian limb array
  */
-static void montgomery_mul(const struct rsa_public_key *key,
-		uint32_t result[], uint32_t a[], const uint32_t b[])
+static void montgomery_mul(const struct mont_key *key,
+		rsa_limb result[], const rsa_limb a[], const rsa_limb b[])
 {
 	uint i;
 
@@ -132,13 +247,39 @@ static void montgomery_mul(const struct rsa_public_key *key,
 		montgomery_mul_add_step(key, result, a[i], b);
 }
 
+/**
+ * shift_mod() - Multiply a value by a power of two, modulo the modulus
+ *
+ * @key:	RSA key
+ * @num:	Value to shift, less than twice the modulus, as little endian
+ *		limb array
+ * @bits:	Number of bits to shift by
+ */
+static void shift_mod(const struct mont_key *key, rsa_limb num[], uint bits)
+{
+	rsa_limb carry, next;
+	uint i;
+
+	if (greater_equal_modulus(key, num))
+		subtract_modulus(key, num);
+	while (bits--) {
+		for (i = 0, carry = 0; i < key->len; i++) {
+			next = num[i] >> (LIMB_BITS - 1);
+			num[i] = num[i] << 1 | carry;
+			carry = next;
+		}
+		if (carry || greater_equal_modulus(key, num))
+			subtract_modulus(key, num);
+	}
+}
+
 /**
  * num_pub_exponent_bits() - Number of bits in the public exponent
  *
  * @key:	RSA key
  * @num_bits:	Storage for the number of public exponent bits
  */
-static int num_public_exponent_bits(const struct rsa_public_key *key,
+static int num_public_exponent_bits(const struct mont_key *key,
 		int *num_bits)
 {
 	uint64_t exponent;
@@ -168,39 +309,92 @@ static int num_public_exponent_bits(const struct rsa_public_key *key,
  * @key:	RSA key
  * @pos:	The bit position to check
  */
-static int is_public_exponent_bit_set(const struct rsa_public_key *key,
+static bool is_public_exponent_bit_set(const struct mont_key *key,
 		int pos)
 {
-	return key->exponent & (1ULL << pos);
+	return !!(key->exponent & (1ULL << pos));
+}
+
+/**
+ * pow_mod_window() - Exponentiation using a sliding window
+ *
+ * This handles long exponents with about one multiply for every
+ * RSA_WINDOW_BITS bits of the exponent, rather than one for each set bit.
+ *
+ * @key:	RSA key
+ * @acc:	On entry, the value to raise in Montgomery form. On exit, the
+ *		result in Montgomery form
+ * @tmp:	Temporary buffer the size of @acc
+ * @k:		Number of bits in the public exponent
+ */
+static __attribute__((__noinline__)) void
+pow_mod_window(const struct mont_key *key, rsa_limb *acc, rsa_limb *tmp, int k)
+{
+	const int count = 1 << (RSA_WINDOW_BITS - 1);
+	rsa_limb table[count][RSA_MAX_LIMBS];
+	rsa_limb *x = acc, *y = tmp, *swap;
+	int i, j, low;
+	uint win;
+
+	/* table[i] = a^(2i + 1), in Montgomery form */
+	memcpy(table[0], acc, key->len * sizeof(rsa_limb));
+	montgomery_mul(key, tmp, acc, acc);
+	for (i = 1; i < count; i++)
+		montgomery_mul(key, table[i], table[i - 1], tmp);
+
+	for (i = k - 1; i >= 0; i = low - 1) {
+		/* find the longest window ending in a set bit */
+		low = i - RSA_WINDOW_BITS + 1;
+		if (low < 0)
+			low = 0;
+		while (low < i && !is_public_exponent_bit_set(key, low))
+			low++;
+		win = (key->exponent >> low) & ((1 << (i - low + 1)) - 1);
+
+		if (i == k - 1) {
+			memcpy(x, table[win >> 1], key->len * sizeof(rsa_limb));
+		} else {
+			for (j = i; j >= low; j--) {
+				montgomery_mul(key, y, x, x);
+				swap = x, x = y, y = swap;
+			}
+			montgomery_mul(key, y, x, table[win >> 1]);
+			swap = x, x = y, y = swap;
+		}
+
+		/* square for each zero bit below the window */
+		while (low > 0 && !is_public_exponent_bit_set(key, low - 1)) {
+			montgomery_mul(key, y, x, x);
+			swap = x, x = y, y = swap;
+			low--;
+		}
+	}
+
+	if (x != acc)
+		memcpy(acc, x, key->len * sizeof(rsa_limb));
 }
 
 /**
  * pow_mod() - in-place public exponentiation
  *
  * @key:	RSA key
- * @inout:	Big-endian word array containing value and result
+ * @inout:	Little-endian limb array containing value and result
  */
-static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
+static int pow_mod(const struct mont_key *key, rsa_limb *inout)
 {
-	uint32_t *result, *ptr;
-	uint i;
+	rsa_limb acc[RSA_MAX_LIMBS], tmp[RSA_MAX_LIMBS];
+	rsa_limb a_scaled[RSA_MAX_LIMBS];
+	const rsa_limb *val = inout;
+	rsa_limb *result;
 	int j, k;
 
-	/* Sanity check for stack size - key->len is in 32-bit words */
-	if (key->len > RSA_MAX_KEY_BITS / 32) {
-		debug("RSA key words %u exceeds maximum %d\n", key->len,
-		      RSA_MAX_KEY_BITS / 32);
+	/* Sanity check for stack size */
+	if (key->len > RSA_MAX_LIMBS) {
+		debug("RSA key limbs %u exceeds maximum %d\n", key->len,
+		      (int)RSA_MAX_LIMBS);
 		return -EINVAL;
 	}
 
-	uint32_t val[key->len], acc[key->len], tmp[key->len];
-	uint32_t a_scaled[key->len];
-	result = tmp;  /* Re-use location. */
-
-	/* Convert from big endian byte array to little endian word array. */
-	for (i = 0, ptr = inout + key->len - 1; i < key->len; i++, ptr--)
-		val[i] = get_unaligned_be32(ptr);
-
 	if (0 != num_public_exponent_bits(key, &k))
 		return -EINVAL;
 
@@ -215,8 +409,24 @@ static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 		return -EINVAL;
 	}
 
-	/* the bit at e[k-1] is 1 by definition, so start with: C := M */
 	montgomery_mul(key, acc, val, key->rr); /* acc = a * RR / R mod n */
+
+	/* correct for a padded top limb, see struct mont_key */
+	if (key->len * LIMB_WORDS != key->len32)
+		shift_mod(key, acc, 64);
+
+	if (k > RSA_WINDOW_MIN_BITS) {
+		pow_mod_window(key, acc, tmp, k);
+
+		/* convert out of Montgomery form: acc * 1 / R mod n */
+		memset(a_scaled, '\0', key->len * sizeof(a_scaled[0]));
+		a_scaled[0] = 1;
+		montgomery_mul(key, tmp, acc, a_scaled);
+		result = tmp;
+		goto done;
+	}
+
+	/* the bit at e[k-1] is 1 by definition, so start with: C := M */
 	/* retain scaled version for intermediate use */
 	memcpy(a_scaled, acc, key->len * sizeof(a_scaled[0]));
 
@@ -235,15 +445,14 @@ static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 	/* the bit at e[0] is always 1 */
 	montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod n */
 	montgomery_mul(key, acc, tmp, val); /* acc = tmp * a / R mod M */
-	memcpy(result, acc, key->len * sizeof(result[0]));
+	result = acc;
 
+done:
 	/* Make sure result < mod; result is at most 1x mod too large. */
 	if (greater_equal_modulus(key, result))
 		subtract_modulus(key, result);
+	memcpy(inout, result, key->len * sizeof(inout[0]));
 
-	/* Convert to bigendian byte array */
-	for (i = key->len - 1, ptr = inout; (int)i >= 0; i--, ptr++)
-		put_unaligned_be32(result[i], ptr);
 	return 0;
 }
 
@@ -258,52 +467,55 @@ static void rsa_convert_big_endian(uint32_t *dst, const uint32_t *src, int len)
 int rsa_mod_exp_sw(const uint8_t *sig, uint32_t sig_len,
 		struct key_prop *prop, uint8_t *out)
 {
-	struct rsa_public_key key;
+	struct mont_key key;
+	uint64_t exponent;
+	uint len;
 	int ret;
 
 	if (!prop) {
 		debug("%s: Skipping invalid prop", __func__);
 		return -EBADF;
 	}
-	key.n0inv = prop->n0inv;
-	key.len = prop->num_bits;
+	len = prop->num_bits;
 
 	if (!prop->public_exponent)
-		key.exponent = RSA_DEFAULT_PUBEXP;
+		exponent = RSA_DEFAULT_PUBEXP;
 	else
-		key.exponent = fdt64_to_cpup(prop->public_exponent);
+		exponent = fdt64_to_cpup(prop->public_exponent);
 
-	if (!key.len || !prop->modulus || !prop->rr) {
+	if (!len || !prop->modulus || !prop->rr) {
 		debug("%s: Missing RSA key info", __func__);
 		return -EFAULT;
 	}
 
 	/* Sanity check for stack size */
-	if (key.len > RSA_MAX_KEY_BITS || key.len < RSA_MIN_KEY_BITS) {
+	if (len > RSA_MAX_KEY_BITS || len < RSA_MIN_KEY_BITS) {
 		debug("RSA key bits %u outside allowed range %d..%d\n",
-		      key.len, RSA_MIN_KEY_BITS, RSA_MAX_KEY_BITS);
+		      len, RSA_MIN_KEY_BITS, RSA_MAX_KEY_BITS);
 		return -EFAULT;
 	}
-	key.len /= sizeof(uint32_t) * 8;
-	uint32_t key1[key.len], key2[key.len];
-
-	key.modulus = key1;
-	key.rr = key2;
-	rsa_convert_big_endian(key.modulus, (uint32_t *)prop->modulus, key.len);
-	rsa_convert_big_endian(key.rr, (uint32_t *)prop->rr, key.len);
-	if (!key.modulus || !key.rr) {
-		debug("%s: Out of memory", __func__);
-		return -ENOMEM;
-	}
+	len /= sizeof(uint32_t) * 8;
+	uint32_t key1[len], key2[len];
+
+	rsa_convert_big_endian(key1, (uint32_t *)prop->modulus, len);
+	rsa_convert_big_endian(key2, (uint32_t *)prop->rr, len);
+	mont_key_init(&key, key1, key2, len, exponent);
 
 	uint32_t buf[sig_len / sizeof(uint32_t)];
+	rsa_limb val[RSA_MAX_LIMBS];
 
+	/* Convert from big endian byte array to little endian limb array. */
 	memcpy(buf, sig, sig_len);
+	rsa_convert_big_endian(key1, buf, len);
+	words_to_limbs(val, key.len, key1, len);
 
-	ret = pow_mod(&key, buf);
+	ret = pow_mod(&key, val);
 	if (ret)
 		return ret;
 
+	/* Convert to bigendian byte array */
+	limbs_to_words(key1, len, val);
+	rsa_convert_big_endian(buf, key1, len);
 	memcpy(out, buf, sig_len);
 
 	return 0;
@@ -314,19 +526,19 @@ int rsa_mod_exp_sw(const uint8_t *sig, uint32_t sig_len,
  * zynq_pow_mod - in-place public exponentiation
  *
  * @keyptr:	RSA key
- * @inout:	Big-endian word array containing value and result
+ * @inout:	Little-endian word array containing value and result
  * Return: 0 on successful calculation, otherwise failure error code
  *
- * FIXME: Use pow_mod() instead of zynq_pow_mod()
- *        pow_mod calculation required for zynq is bit different from
- *        pw_mod above here, hence defined zynq specific routine.
+ * This differs from rsa_mod_exp_sw() in taking the key as a struct
+ * rsa_public_key and the value as a little-endian word array, and always uses
+ * the default exponent.
  */
 int zynq_pow_mod(uint32_t *keyptr, uint32_t *inout)
 {
-	u32 *result, *ptr;
-	uint i;
 	struct rsa_public_key *key;
-	u32 val[RSA2048_BYTES], acc[RSA2048_BYTES], tmp[RSA2048_BYTES];
+	struct mont_key mkey;
+	rsa_limb val[RSA_MAX_LIMBS];
+	int ret;
 
 	key = (struct rsa_public_key *)keyptr;
 
@@ -337,24 +549,13 @@ int zynq_pow_mod(uint32_t *keyptr, uint32_t *inout)
 		return -EINVAL;
 	}
 
-	result = tmp;  /* Re-use location. */
-
-	for (i = 0, ptr = inout; i < key->len; i++, ptr++)
-		val[i] = *(ptr);
-
-	montgomery_mul(key, acc, val, key->rr);  /* axx = a * RR / R mod M */
-	for (i = 0; i < 16; i += 2) {
-		montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod M */
-		montgomery_mul(key, acc, tmp, tmp); /* acc = tmp^2 / R mod M */
-	}
-	montgomery_mul(key, result, acc, val);  /* result = XX * a / R mod M */
-
-	/* Make sure result < mod; result is at most 1x mod too large. */
-	if (greater_equal_modulus(key, result))
-		subtract_modulus(key, result);
-
-	for (i = 0, ptr = inout; i < key->len; i++, ptr++)
-		*ptr = result[i];
+	mont_key_init(&mkey, key->modulus, key->rr, key->len,
+		      RSA_DEFAULT_PUBEXP);
+	words_to_limbs(val, mkey.len, inout, key->len);
+	ret = pow_mod(&mkey, val);
+	if (ret)
+		return ret;
+	limbs_to_words(inout, key->len, val);
 
 	return 0;
 }
@@ -8,6 +8,8 @@
 #include <fdtdec.h>
 #include <log.h>
 #include <malloc.h>
+#include <stat.h>
+#include <asm/global_data.h>
 #include <asm/types.h>
 #include <asm/byteorder.h>
 #include <linux/errno.h>
@@ -380,6 +382,112 @@ static int rsa_verify_key(struct image_sign_info *info,
 	return 0;
 }
 
+#if !defined(USE_HOSTCC) && CONFIG_IS_ENABLED(RSA_VERIFY_KEY_CACHE)
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	RSA_KEY_CACHE_SIZE	= 4,
+};
+
+/**
+ * struct rsa_key_cache - A public key whose properties are known
+ *
+ * @key: Copy of the DER-encoded key, or NULL if this entry is unused
+ * @keylen: Length of @key in bytes
+ * @prop: Properties from rsa_gen_key_prop()
+ */
+struct rsa_key_cache {
+	void *key;
+	uint keylen;
+	struct key_prop *prop;
+};
+
+static struct rsa_key_cache rsa_key_cache[RSA_KEY_CACHE_SIZE];
+static uint rsa_key_cache_next;
+
+STAT_COUNTER_DEFINE(rsa, key_hits);
+STAT_COUNTER_DEFINE(rsa, key_misses);
+
+/**
+ * rsa_key_cache_find() - Look up the properties of a public key
+ *
+ * @key:	DER-encoded key
+ * @keylen:	Length of @key
+ * Return: properties, or NULL if the key is not in the cache
+ */
+static struct key_prop *rsa_key_cache_find(const void *key, uint keylen)
+{
+	int i;
+
+	/* the cache lives in BSS, which is not available yet */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return NULL;
+
+	for (i = 0; i < RSA_KEY_CACHE_SIZE; i++) {
+		struct rsa_key_cache *entry = &rsa_key_cache[i];
+
+		if (entry->key && entry->keylen == keylen &&
+		    !memcmp(entry->key, key, keylen)) {
+			STAT_INC(rsa, key_hits);
+			return entry->prop;
+		}
+	}
+	STAT_INC(rsa, key_misses);
+
+	return NULL;
+}
+
+/**
+ * rsa_key_cache_add() - Remember the properties of a public key
+ *
+ * This replaces the oldest entry once the cache is full. If this returns true
+ * the cache owns @prop and the caller must not free it.
+ *
+ * @key:	DER-encoded key
+ * @keylen:	Length of @key
+ * @prop:	Properties from rsa_gen_key_prop()
+ * Return: true if @prop was added, false if not
+ */
+static bool rsa_key_cache_add(const void *key, uint keylen,
+			      struct key_prop *prop)
+{
+	struct rsa_key_cache *entry;
+	void *copy;
+
+	/* the cache lives in BSS, which is not available yet */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return false;
+
+	copy = malloc(keylen);
+	if (!copy)
+		return false;
+	memcpy(copy, key, keylen);
+
+	entry = &rsa_key_cache[rsa_key_cache_next];
+	rsa_key_cache_next = (rsa_key_cache_next + 1) % RSA_KEY_CACHE_SIZE;
+	if (entry->key) {
+		free(entry->key);
+		rsa_free_key_prop(entry->prop);
+	}
+	entry->key = copy;
+	entry->keylen = keylen;
+	entry->prop = prop;
+
+	return true;
+}
+#else
+static struct key_prop *rsa_key_cache_find(const void *key, uint keylen)
+{
+	return NULL;
+}
+
+static bool rsa_key_cache_add(const void *key, uint keylen,
+			      struct key_prop *prop)
+{
+	return false;
+}
+#endif
+
 /**
  * rsa_verify_with_pkey() - Verify a signature against some data using
  * only modulus and exponent as RSA key properties.
@@ -390,7 +498,8 @@ static int rsa_verify_key(struct image_sign_info *info,
  *
  * Parse a RSA public key blob in DER format pointed to in @info and fill
  * a key_prop structure with properties of the key. Then verify a RSA PKCS1.5
- * signature against an expected hash using the calculated properties.
+ * signature against an expected hash using the calculated properties. The
+ * properties of recently used keys are kept, see CONFIG_RSA_VERIFY_KEY_CACHE.
  *
  * Return	0 if verified, -ve on error
  */
@@ -398,22 +507,28 @@ int rsa_verify_with_pkey(struct image_sign_info *info,
 			 const void *hash, uint8_t *sig, uint sig_len)
 {
 	struct key_prop *prop;
+	bool cached = true;
 	int ret;
 
 	if (!CONFIG_IS_ENABLED(RSA_VERIFY_WITH_PKEY))
 		return -EACCES;
 
-	/* Public key is self-described to fill key_prop */
-	ret = rsa_gen_key_prop(info->key, info->keylen, &prop);
-	if (ret) {
-		debug("Generating necessary parameter for decoding failed\n");
-		return ret;
+	prop = rsa_key_cache_find(info->key, info->keylen);
+	if (!prop) {
+		/* Public key is self-described to fill key_prop */
+		ret = rsa_gen_key_prop(info->key, info->keylen, &prop);
+		if (ret) {
+			debug("Generating necessary parameter for decoding failed\n");
+			return ret;
+		}
+		cached = rsa_key_cache_add(info->key, info->keylen, prop);
 	}
 
 	ret = rsa_verify_key(info, prop, sig, sig_len, hash,
 			     info->crypto->key_len);
 
-	rsa_free_key_prop(prop);
+	if (!cached)
+		rsa_free_key_prop(prop);
 
 	return ret;
 }
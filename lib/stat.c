@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Hot-path event counters
+ */
+
+#include <common.h>
+#include <stat.h>
+#include <linux/libfdt.h>
+
+static uint stat_len(const struct stat_entry *stat)
+{
+	return stat->type == STAT_HIST ? STAT_HIST_BUCKETS : 1;
+}
+
+static bool stat_match(const struct stat_entry *stat, const char *subsys)
+{
+	return !subsys || !strcmp(stat->subsys, subsys);
+}
+
+static bool stat_is_zero(const struct stat_entry *stat)
+{
+	uint i;
+
+	for (i = 0; i < stat_len(stat); i++) {
+		if (stat->data[i])
+			return false;
+	}
+
+	return true;
+}
+
+static void stat_show_hist(const struct stat_entry *stat)
+{
+	ulong total = 0;
+	uint i;
+
+	for (i = 0; i < STAT_HIST_BUCKETS; i++)
+		total += stat->data[i];
+	printf("%-8s %-20s %12lu samples\n", stat->subsys, stat->name, total);
+	for (i = 0; i < STAT_HIST_BUCKETS; i++) {
+		if (!stat->data[i])
+			continue;
+		if (!i)
+			printf("%29s%-12s", "", "0");
+		else if (i == STAT_HIST_BUCKETS - 1)
+			printf("%29s>= %-9lu", "", 1UL << (i - 1));
+		else
+			printf("%29s< %-10lu", "", 1UL << i);
+		printf("%12lu\n", stat->data[i]);
+	}
+}
+
+void stat_show(const char *subsys)
+{
+	struct stat_entry *start = ll_entry_start(struct stat_entry, stat);
+	const int count = ll_entry_count(struct stat_entry, stat);
+	struct stat_entry *stat;
+
+	printf("%-8s %-20s %12s\n", "Subsys", "Name", "Value");
+	for (stat = start; stat != start + count; stat++) {
+		if (!stat_match(stat, subsys) || stat_is_zero(stat))
+			continue;
+		if (stat->type == STAT_HIST)
+			stat_show_hist(stat);
+		else
+			printf("%-8s %-20s %12lu\n", stat->subsys, stat->name,
+			       stat->data[0]);
+	}
+}
+
+void stat_reset(const char *subsys)
+{
+	struct stat_entry *start = ll_entry_start(struct stat_entry, stat);
+	const int count = ll_entry_count(struct stat_entry, stat);
+	struct stat_entry *stat;
+
+	for (stat = start; stat != start + count; stat++) {
+		if (stat_match(stat, subsys))
+			memset(stat->data, '\0',
+			       stat_len(stat) * sizeof(*stat->data));
+	}
+}
+
+int stat_fdt_add(void *blob, int parent)
+{
+	struct stat_entry *start = ll_entry_start(struct stat_entry, stat);
+	const int count = ll_entry_count(struct stat_entry, stat);
+	struct stat_entry *stat;
+	fdt64_t val[STAT_HIST_BUCKETS];
+	char name[64];
+	int node;
+
+	node = fdt_add_subnode(blob, parent, "stats");
+	if (node < 0)
+		return -EINVAL;
+
+	for (stat = start; stat != start + count; stat++) {
+		uint i;
+
+		if (stat_is_zero(stat))
+			continue;
+		for (i = 0; i < stat_len(stat); i++)
+			val[i] = cpu_to_fdt64(stat->data[i]);
+		snprintf(name, sizeof(name), "%s-%s", stat->subsys,
+			 stat->name);
+		if (fdt_setprop(blob, node, name, val,
+				stat_len(stat) * sizeof(*val)))
+			return -EINVAL;
+	}
+
+	return 0;
+}
@@ -15,6 +15,7 @@
 #include <log.h>
 #include <net.h>
 #include <nvmem.h>
+#include <stat.h>
 #include <asm/global_data.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
@@ -24,6 +25,13 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+STAT_COUNTER_DEFINE(net, tx_packets);
+STAT_COUNTER_DEFINE(net, tx_bytes);
+STAT_COUNTER_DEFINE(net, tx_errors);
+STAT_COUNTER_DEFINE(net, rx_packets);
+STAT_COUNTER_DEFINE(net, rx_bytes);
+STAT_COUNTER_DEFINE(net, rx_errors);
+
 /**
  * struct eth_device_priv - private structure for each Ethernet device
  *
@@ -392,6 +400,10 @@ int eth_send(void *packet, int length)
 	if (ret < 0) {
 		/* We cannot completely return the error at present */
 		debug("%s: send() returned error %d\n", __func__, ret);
+		STAT_INC(net, tx_errors);
+	} else {
+		STAT_INC(net, tx_packets);
+		STAT_ADD(net, tx_bytes, length);
 	}
 #if defined(CONFIG_CMD_PCAP)
 	if (ret >= 0)
@@ -420,8 +432,11 @@ int eth_rx(void)
 	for (i = 0; i < ETH_PACKETS_BATCH_RECV; i++) {
 		ret = eth_get_ops(current)->recv(current, flags, &packet);
 		flags = 0;
-		if (ret > 0)
+		if (ret > 0) {
+			STAT_INC(net, rx_packets);
+			STAT_ADD(net, rx_bytes, ret);
 			net_process_received_packet(packet, ret);
+		}
 		if (ret >= 0 && eth_get_ops(current)->free_pkt)
 			eth_get_ops(current)->free_pkt(current, packet, ret);
 		if (ret <= 0)
@@ -432,6 +447,7 @@ int eth_rx(void)
 	if (ret < 0) {
 		/* We cannot completely return the error at present */
 		debug("%s: recv() returned error %d\n", __func__, ret);
+		STAT_INC(net, rx_errors);
 	}
 	return ret;
 }
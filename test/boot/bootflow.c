@@ -508,6 +508,53 @@ static int bootflow_cmd_boot(struct unit_test_state *uts)
 }
 BOOTSTD_TEST(bootflow_cmd_boot, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
 
+/* Check that a file shared by two extlinux labels is only read once */
+static int bootflow_extlinux_reuse(struct unit_test_state *uts)
+{
+	static const char conf[] =
+		"default first\n"
+		"label first\n"
+		"\tkernel /vmlinuz-5.3.7-301.fc31.armv7hl\n"
+		"label second\n"
+		"\tkernel /vmlinuz-5.3.7-301.fc31.armv7hl\n";
+	struct bootstd_priv *std;
+	struct bootflow *bflow;
+
+	if (!IS_ENABLED(CONFIG_PXE_FILE_CACHE))
+		return -EAGAIN;
+	ut_assertok(bootstd_get_priv(&std));
+
+	console_record_reset_enable();
+	ut_assertok(run_command("bootdev select 1", 0));
+	ut_assertok(run_command("bootflow scan", 0));
+	ut_assertok(run_command("bootflow select 0", 0));
+	ut_assert_console_end();
+
+	/* Replace the extlinux.conf with one where both labels fail to boot */
+	bflow = std->cur_bootflow;
+	ut_assertnonnull(bflow);
+	free(bflow->buf);
+	bflow->buf = strdup(conf);
+	ut_assertnonnull(bflow->buf);
+	bflow->size = strlen(conf);
+
+	ut_asserteq(1, run_command("bootflow boot", 0));
+	ut_assert_nextline(
+		"** Booting bootflow 'mmc1.bootdev.part_1' with extlinux");
+	ut_assert_skip_to_line(
+		"Retrieving file: /vmlinuz-5.3.7-301.fc31.armv7hl");
+	ut_assert_skip_to_line("sandbox: continuing, as we cannot run Linux");
+
+	/* The second label finds the kernel still in memory */
+	ut_assert_skip_to_line("Reusing file: /vmlinuz-5.3.7-301.fc31.armv7hl");
+	ut_assert_skip_to_line("sandbox: continuing, as we cannot run Linux");
+	ut_assert_nextline("Boot failed (err=-14)");
+	ut_assert_console_end();
+
+	return 0;
+}
+BOOTSTD_TEST(bootflow_extlinux_reuse, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
 /**
  * prep_mmc_bootdev() - Set up an mmc bootdev so we can access other distros
  *
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the mtest command
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <mapmem.h>
+#include <test/suites.h>
+#include <test/ut.h>
+
+/* Declare a new mem test */
+#define MEM_TEST(_name, _flags)	UNIT_TEST(_name, _flags, mem_test)
+
+/* Test the parallel memory test */
+static int mem_test_mtest_parallel(struct unit_test_state *uts)
+{
+	ulong *buf;
+
+	buf = map_sysmem(0x100000, 0x2000);
+	memset(buf, '\0', 0x2000);
+	ut_assertok(console_record_reset_enable());
+	ut_assertok(run_command("mtest -p 100000 102000 0 2", 0));
+	ut_assert_nextline("Testing 00100000 ... 00102000:");
+	ut_assert_nextline("Using 1 hart(s)");
+	ut_assert_skip_to_line("Tested 2 iteration(s) with 0 errors.");
+	ut_assert_nextlinen("main: ");
+	ut_assert_console_end();
+
+	/* the second iteration uses the inverted pattern, so ends with it */
+	ut_asserteq_64((u64)~0UL, buf[0]);
+	ut_asserteq_64((u64)~0UL, buf[0x2000 / sizeof(ulong) - 1]);
+
+	/* flushing the caches needs the parallel test */
+	ut_asserteq(1, run_command("mtest -c 100000 102000 0 1", 0));
+	console_record_reset();
+	unmap_sysmem(buf);
+
+	return 0;
+}
+MEM_TEST(mem_test_mtest_parallel, UT_TESTF_CONSOLE_REC);
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the bootstage trace-event JSON output
+ */
+
+#include <common.h>
+#include <bootstage.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define JSON_HEAD	"{\"traceEvents\":[\n"
+#define JSON_TAIL	"{}],\"displayTimeUnit\":\"ms\"}\n"
+
+/* Test that bootstage records are written as trace-event JSON */
+static int common_test_bootstage_json(struct unit_test_state *uts)
+{
+	char buf[0x4000], small[16];
+	int len;
+
+	bootstage_mark_name(BOOTSTAGE_ID_ALLOC, "json \"test\"");
+
+	len = bootstage_export_json(buf, sizeof(buf));
+	ut_assert(len < sizeof(buf));
+	ut_asserteq(len, strlen(buf));
+	ut_asserteq_mem(JSON_HEAD, buf, strlen(JSON_HEAD));
+	ut_asserteq_str(JSON_TAIL, buf + len - strlen(JSON_TAIL));
+
+	/* Events use the same process as proftool, with names escaped */
+	ut_assertnonnull(strstr(buf, "\"name\":\"U-Boot\""));
+	ut_assertnull(strstr(buf, "\"pid\":0"));
+	ut_assertnonnull(strstr(buf, "\"name\":\"json \\\"test\\\"\",\"cat\":\"mark\""));
+
+	/* A short buffer is filled and terminated, and the full size returned */
+	memset(small, 'x', sizeof(small));
+	ut_asserteq(len, bootstage_export_json(small, sizeof(small)));
+	ut_asserteq(sizeof(small) - 1, strlen(small));
+	ut_asserteq_mem(buf, small, sizeof(small) - 1);
+
+	return 0;
+}
+COMMON_TEST(common_test_bootstage_json, 0);
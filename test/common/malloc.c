@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the malloc() cache, heap information and arenas
+ */
+
+#include <common.h>
+#include <arena.h>
+#include <malloc.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <linux/sizes.h>
+
+/* Test that a freed small chunk is handed straight back out */
+static int common_test_malloc_cache(struct unit_test_state *uts)
+{
+	struct malloc_info before, after;
+	void *ptr, *again;
+	ulong start;
+
+	if (!IS_ENABLED(CONFIG_SYS_MALLOC_CACHE))
+		return -EAGAIN;
+
+	/* start with an empty cache so the chunk cannot go to the bins */
+	malloc_cache_flush(0);
+	start = ut_check_free();
+	ptr = malloc(40);
+	ut_assertnonnull(ptr);
+	free(ptr);
+
+	/* a cached chunk counts as free */
+	ut_asserteq(0, ut_check_delta(start));
+	malloc_get_info(&before);
+	ut_assert(before.cached_chunks >= 1);
+
+	again = malloc(40);
+	ut_asserteq_ptr(ptr, again);
+	malloc_get_info(&after);
+	ut_asserteq(before.cache_hits + 1, after.cache_hits);
+	free(again);
+
+	/* chunks given to a CPU come back out of its cache */
+	ut_asserteq(-EINVAL, malloc_cache_fill(0, CONFIG_SYS_MALLOC_CACHE_MAX,
+					       1));
+	ut_asserteq(-EINVAL, malloc_cache_fill(CONFIG_SYS_MALLOC_CACHE_CPUS,
+					       40, 1));
+	malloc_cache_flush(0);
+	ut_assertok(malloc_cache_fill(0, 40, 2));
+	malloc_get_info(&after);
+	ut_asserteq(2, after.cached_chunks);
+
+	/* flushing puts them back in the bins, not in another cache */
+	malloc_cache_flush(0);
+	malloc_get_info(&after);
+	ut_asserteq(0, after.cached_chunks);
+	ut_asserteq(0, ut_check_delta(start));
+
+	return 0;
+}
+COMMON_TEST(common_test_malloc_cache, 0);
+
+/* Test that heap information follows allocations */
+static int common_test_malloc_info(struct unit_test_state *uts)
+{
+	struct malloc_info before, after;
+	const ulong size = SZ_1M;
+	void *ptr;
+
+	malloc_get_info(&before);
+	ut_assert(before.total >= before.in_use + before.free);
+	ut_assert(before.largest_free <= before.free);
+
+	ptr = malloc(size);
+	ut_assertnonnull(ptr);
+	malloc_get_info(&after);
+	ut_assert(after.in_use >= before.in_use + size);
+	ut_assert(after.peak >= after.in_use);
+	free(ptr);
+
+	malloc_get_info(&after);
+	ut_asserteq(before.in_use, after.in_use);
+	ut_assert(after.peak >= before.in_use + size);
+
+	return 0;
+}
+COMMON_TEST(common_test_malloc_info, 0);
+
+#ifdef CONFIG_ARENA
+/* Test taking and releasing arena checkpoints */
+static int common_test_arena(struct unit_test_state *uts)
+{
+	struct arena_mark mark, empty;
+	struct arena arena;
+	ulong start;
+	char *ptr[4];
+
+	start = ut_check_free();
+	arena_init(&arena, 256);
+	arena_mark(&arena, &empty);
+
+	ptr[0] = arena_alloc(&arena, 10);
+	ut_assertnonnull(ptr[0]);
+	ut_asserteq(0, (ulong)ptr[0] & 15);
+	ptr[1] = arena_alloc(&arena, 10);
+	ut_asserteq_ptr(ptr[0] + 16, ptr[1]);
+
+	/* release back to a checkpoint in the same block */
+	arena_mark(&arena, &mark);
+	ptr[2] = arena_alloc(&arena, 100);
+	ut_asserteq_ptr(ptr[1] + 16, ptr[2]);
+	arena_release(&arena, &mark);
+	ut_asserteq_ptr(ptr[2], arena_alloc(&arena, 100));
+
+	/* allocations larger than a block, and across several blocks */
+	arena_release(&arena, &mark);
+	ptr[3] = arena_alloc(&arena, 1000);
+	ut_assertnonnull(ptr[3]);
+	memset(ptr[3], '\xff', 1000);
+	ut_assertnonnull(arena_alloc(&arena, 200));
+	ut_assertnonnull(arena_alloc(&arena, 200));
+	arena_release(&arena, &mark);
+	ut_asserteq_ptr(ptr[2], arena_alloc(&arena, 100));
+
+	/* releasing everything gives back all the memory */
+	arena_release(&arena, &empty);
+	ut_assertnull(arena.block);
+	ut_asserteq(0, ut_check_delta(start));
+
+	ut_assertnonnull(arena_alloc(&arena, 10));
+	arena_uninit(&arena);
+	ut_asserteq(0, ut_check_delta(start));
+
+	return 0;
+}
+COMMON_TEST(common_test_arena, 0);
+#endif
@@ -8,6 +8,7 @@
 #include <dm.h>
 #include <part.h>
 #include <sandbox_host.h>
+#include <stat.h>
 #include <usb.h>
 #include <asm/global_data.h>
 #include <asm/state.h>
@@ -335,3 +336,37 @@ static int dm_test_blk_foreach(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_blk_foreach, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Test writing only the blocks which have changed */
+static int dm_test_blk_write_changed(struct unit_test_state *uts)
+{
+	char write[140 * 512], read[140 * 512];
+	struct blk_desc *desc;
+	int i;
+
+	ut_assertok(blk_get_device_by_str("mmc", "0", &desc));
+	ut_asserteq(512, desc->blksz);
+	for (i = 0; i < sizeof(write); i++)
+		write[i] = i;
+	ut_asserteq(140, blk_dwrite(desc, 0, 140, write));
+
+	/* change a few blocks, including the last one, in both chunks */
+	write[3 * 512] ^= 0xff;
+	write[4 * 512 + 100] ^= 0xff;
+	write[130 * 512] ^= 0xff;
+	write[139 * 512 + 511] ^= 0xff;
+	stat_reset("blk");
+	ut_asserteq(140, blk_dwrite_changed(desc, 0, 140, write));
+	ut_asserteq(140, blk_dread(desc, 0, 140, read));
+	ut_asserteq_mem(write, read, sizeof(write));
+
+#if CONFIG_IS_ENABLED(STATS)
+	ut_asserteq(4, ll_entry_get(struct stat_entry, blk_write_blocks,
+				    stat)->data[0]);
+	ut_asserteq(136, ll_entry_get(struct stat_entry, blk_unchanged_blocks,
+				      stat)->data[0]);
+#endif
+
+	return 0;
+}
+DM_TEST(dm_test_blk_write_changed, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -13,6 +13,7 @@
 #include <malloc.h>
 #include <asm/global_data.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/test.h>
@@ -1353,3 +1354,144 @@ static int dm_test_dev_get_mem(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_dev_get_mem, UT_TESTF_SCAN_FDT);
+
+/* Test that compatible-string lookup picks the first driver in the list */
+static int dm_test_lists_match_compat(struct unit_test_state *uts)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *of_id, *id;
+	struct driver *entry, *drv, *first;
+	int i;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (of_id = entry->of_match; of_id && of_id->compatible;
+		     of_id++) {
+			ut_assertok(lists_driver_match_compat(of_id->compatible,
+							      &drv, &id));
+			ut_asserteq_str(of_id->compatible, id->compatible);
+
+			/* Find the first driver with this compatible string */
+			for (first = driver; first != entry; first++) {
+				const struct udevice_id *match;
+
+				for (match = first->of_match;
+				     match && match->compatible; match++) {
+					if (!strcmp(match->compatible,
+						    of_id->compatible))
+						break;
+				}
+				if (match && match->compatible)
+					break;
+			}
+			ut_asserteq_ptr(first, drv);
+		}
+	}
+	ut_asserteq(-ENOENT,
+		    lists_driver_match_compat("u-boot,no-such-device", &drv,
+					      &id));
+
+	for (i = 0; i < UCLASS_COUNT; i++) {
+		struct uclass_driver *uc_drv = lists_uclass_lookup(i);
+
+		if (uc_drv)
+			ut_asserteq(i, uc_drv->id);
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_lists_match_compat, 0);
+
+/* Test that indexed uclass lookups agree with a walk of the device list */
+static int dm_test_uclass_find_index(struct unit_test_state *uts)
+{
+	struct udevice *dev, *found, *first;
+	ofnode node, other;
+	struct uclass *uc;
+
+	list_for_each_entry(uc, gd->uclass_root, sibling_node) {
+		enum uclass_id id = uc->uc_drv->id;
+
+		uclass_foreach_dev(dev, uc) {
+			if (dev_seq(dev) != -1) {
+				uclass_foreach_dev(first, uc) {
+					if (dev_seq(first) == dev_seq(dev))
+						break;
+				}
+				ut_assertok(uclass_find_device_by_seq(id,
+						dev_seq(dev), &found));
+				ut_asserteq_ptr(first, found);
+			}
+			if (dev_has_ofnode(dev)) {
+				uclass_foreach_dev(first, uc) {
+					if (ofnode_equal(dev_ofnode(first),
+							 dev_ofnode(dev)))
+						break;
+				}
+				ut_assertok(uclass_find_device_by_ofnode(id,
+						dev_ofnode(dev), &found));
+				ut_asserteq_ptr(first, found);
+			}
+		}
+	}
+	ut_asserteq(-ENODEV, uclass_find_device_by_seq(UCLASS_TEST_FDT, 1000,
+						       &found));
+
+	/* The root node is set after the root device is bound */
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_ROOT, ofnode_root(),
+						 &found));
+	ut_asserteq_ptr(dm_root(), found);
+
+	/* Moving a device to another node must update the index */
+	ut_assertok(uclass_first_device_err(UCLASS_TEST_FDT, &dev));
+	node = dev_ofnode(dev);
+	other = ofnode_path("/some-bus");
+	dev_set_ofnode(dev, other);
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_FDT, other,
+						 &found));
+	ut_asserteq_ptr(dev, found);
+	ut_asserteq(-ENODEV, uclass_find_device_by_ofnode(UCLASS_TEST_FDT, node,
+							  &found));
+	dev_set_ofnode(dev, node);
+	ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_FDT, node,
+						 &found));
+	ut_asserteq_ptr(dev, found);
+
+	return 0;
+}
+DM_TEST(dm_test_uclass_find_index, UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+/* Test that the uclass index is only built after relocation */
+static int dm_test_uclass_index_reloc(struct unit_test_state *uts)
+{
+	struct udevice *dev, *found;
+	struct uclass *uc;
+	bool built;
+	int ret;
+
+	ut_assertok(uclass_get(UCLASS_TEST_FDT, &uc));
+	ut_assert(!uc->index.built);
+	dev = list_last_entry(&uc->dev_head, struct udevice, uclass_node);
+	ut_assert(dev_seq(dev) != -1);
+
+	/* before relocation the device list is walked */
+	gd->flags &= ~GD_FLG_RELOC;
+	ret = uclass_find_device_by_seq(UCLASS_TEST_FDT, dev_seq(dev), &found);
+	built = uc->index.built;
+	gd->flags |= GD_FLG_RELOC;
+	ut_assertok(ret);
+	ut_asserteq_ptr(dev, found);
+	ut_assert(!built);
+
+	/* the first lookup afterwards builds the index */
+	ut_assertok(uclass_find_device_by_seq(UCLASS_TEST_FDT, dev_seq(dev),
+					      &found));
+	ut_asserteq_ptr(dev, found);
+	ut_assert(uc->index.built);
+	ut_assert(uc->index.count > 0);
+
+	return 0;
+}
+DM_TEST(dm_test_uclass_index_reloc, UT_TESTF_SCAN_FDT);
+#endif
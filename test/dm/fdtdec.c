@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include <dm.h>
+#include <fdt_support.h>
 #include <asm/global_data.h>
 #include <dm/of_extra.h>
 #include <dm/test.h>
@@ -130,3 +131,32 @@ static int dm_test_fdtdec_add_reserved_memory(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_fdtdec_add_reserved_memory,
 	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT | UT_TESTF_FLAT_TREE);
+
+/* Test that fdt_ensure_space() only grows the tree when needed */
+static int dm_test_fdt_ensure_space(struct unit_test_state *uts)
+{
+	int ts, used;
+	void *blob;
+
+	/* Make a writable copy of the fdt blob, with 1KB to spare */
+	ts = fdt_totalsize(gd->fdt_blob) + 1024;
+	blob = malloc(ts * 2);
+	ut_assertnonnull(blob);
+	ut_assertok(fdt_open_into(gd->fdt_blob, blob, ts));
+	used = fdt_off_dt_strings(blob) + fdt_size_dt_strings(blob);
+
+	/* there is enough room already */
+	ut_assertok(fdt_ensure_space(blob, ts - used));
+	ut_asserteq(ts, fdt_totalsize(blob));
+
+	/* there is not */
+	ut_assertok(fdt_ensure_space(blob, ts - used + 1));
+	ut_asserteq(ts + ts - used + 1, fdt_totalsize(blob));
+	ut_assertok(fdt_check_header(blob));
+	ut_assert(fdt_add_subnode(blob, 0, "ensure-space") >= 0);
+
+	free(blob);
+
+	return 0;
+}
+DM_TEST(dm_test_fdt_ensure_space, 0);
@@ -4,7 +4,10 @@
  */
 
 #include <common.h>
+#include <blk.h>
+#include <command.h>
 #include <dm.h>
+#include <malloc.h>
 #include <mmc.h>
 #include <part.h>
 #include <part_efi.h>
@@ -195,3 +198,120 @@ static int dm_test_part_get_info_by_type(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_part_get_info_by_type, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+static int do_restore_gpt(struct unit_test_state *uts, struct blk_desc *desc,
+			  const char *name1, const char *name2)
+{
+	char str_disk_guid[UUID_STR_LEN + 1];
+	struct disk_partition parts[2] = {
+		{
+			.start = 48, /* GPT data takes up the first 34 blocks or so */
+			.size = 1,
+		},
+		{
+			.start = 49,
+			.size = 1,
+		},
+	};
+
+	strlcpy((char *)parts[0].name, name1, sizeof(parts[0].name));
+	strlcpy((char *)parts[1].name, name2, sizeof(parts[1].name));
+	if (CONFIG_IS_ENABLED(RANDOM_UUID)) {
+		gen_rand_uuid_str(parts[0].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(parts[1].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(str_disk_guid, UUID_STR_FORMAT_STD);
+	}
+	ut_assertok(gpt_restore(desc, str_disk_guid, parts, ARRAY_SIZE(parts)));
+
+	return 0;
+}
+
+/* Test that lookups by name see changes to the GPT */
+static int dm_test_part_gpt_cache(struct unit_test_state *uts)
+{
+	struct disk_partition info;
+	struct blk_desc *desc;
+	char buf[512];
+
+	ut_asserteq(2, blk_get_device_by_str("mmc", "2", &desc));
+	ut_assertok(do_restore_gpt(uts, desc, "one", "two"));
+	ut_asserteq(2, part_get_info_by_name(desc, "two", &info));
+	ut_asserteq_str("two", (char *)info.name);
+	ut_asserteq(49, info.start);
+	ut_asserteq(1, part_get_info_by_name(desc, "one", &info));
+	ut_asserteq(-ENOENT, part_get_info_by_name(desc, "three", &info));
+
+	/* writing the usable area leaves the GPT alone */
+	memset(buf, '\0', sizeof(buf));
+	ut_asserteq(1, blk_dwrite(desc, 48, 1, buf));
+#if CONFIG_IS_ENABLED(EFI_PARTITION_CACHE)
+	ut_assertnonnull(desc->gpt_cache);
+#endif
+
+	/* rewriting the GPT must be noticed */
+	ut_assertok(do_restore_gpt(uts, desc, "two", "three"));
+	ut_asserteq(1, part_get_info_by_name(desc, "two", &info));
+	ut_asserteq(48, info.start);
+	ut_asserteq(2, part_get_info_by_name(desc, "three", &info));
+	ut_asserteq(-ENOENT, part_get_info_by_name(desc, "one", &info));
+
+	/* the first of two partitions with the same name is found */
+	ut_assertok(do_restore_gpt(uts, desc, "dup", "dup"));
+	ut_asserteq(1, part_get_info_by_name(desc, "dup", &info));
+
+	return 0;
+}
+DM_TEST(dm_test_part_gpt_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Write blocks with the driver, so the block layer does not see the change */
+static int write_behind(struct unit_test_state *uts, struct blk_desc *desc,
+			lbaint_t start, lbaint_t blkcnt, const void *buf)
+{
+	struct blk_ops *ops = (struct blk_ops *)desc->bdev->driver->ops;
+
+	ut_asserteq(blkcnt, ops->write(desc->bdev, start, blkcnt, buf));
+
+	return 0;
+}
+
+/* Test that rescanning an MMC drops the cached GPT */
+static int dm_test_part_gpt_cache_rescan(struct unit_test_state *uts)
+{
+	const lbaint_t gpt_blks = 34;
+	struct disk_partition info;
+	struct blk_desc *desc;
+	char *pri, *alt;
+	lbaint_t alt_start;
+
+	ut_asserteq(2, blk_get_device_by_str("mmc", "2", &desc));
+	alt_start = desc->lba - gpt_blks + 1;
+	pri = malloc(gpt_blks * desc->blksz);
+	alt = malloc(gpt_blks * desc->blksz);
+	ut_assertnonnull(pri);
+	ut_assertnonnull(alt);
+
+	/* keep a copy of a GPT to put back later */
+	ut_assertok(do_restore_gpt(uts, desc, "two", "three"));
+	ut_asserteq(gpt_blks, blk_dread(desc, 0, gpt_blks, pri));
+	ut_asserteq(gpt_blks - 1, blk_dread(desc, alt_start, gpt_blks - 1, alt));
+
+	ut_assertok(do_restore_gpt(uts, desc, "one", "two"));
+	ut_asserteq(1, part_get_info_by_name(desc, "one", &info));
+
+	/* swap the GPT behind the block layer, as a card swap would */
+	ut_assertok(write_behind(uts, desc, 0, gpt_blks, pri));
+	ut_assertok(write_behind(uts, desc, alt_start, gpt_blks - 1, alt));
+
+	ut_assertok(run_command("mmc dev 2", 0));
+	ut_assertok(run_command("mmc rescan", 0));
+	ut_asserteq(-ENOENT, part_get_info_by_name(desc, "one", &info));
+	ut_asserteq(1, part_get_info_by_name(desc, "two", &info));
+	ut_asserteq(2, part_get_info_by_name(desc, "three", &info));
+
+	free(alt);
+	free(pri);
+
+	return 0;
+}
+DM_TEST(dm_test_part_gpt_cache_rescan,
+	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -178,6 +178,47 @@ static int dm_test_video_text(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_text, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+/* Test that only the part of the frame buffer drawn on needs syncing */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+	ulong start, end;
+	int line_length;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_DAMAGE))
+		return -EAGAIN;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	ut_assertok(vidconsole_select_font(con, "8x16", 0));
+	priv = dev_get_uclass_priv(dev);
+	line_length = priv->line_length;
+
+	ut_assertok(video_sync(dev, false));
+	ut_assert(!video_get_damage(dev, &start, &end));
+
+	/* a character covers its own rows */
+	vidconsole_putc_xy(con, VID_TO_POS(8), 16, 'a');
+	ut_assert(video_get_damage(dev, &start, &end));
+	ut_asserteq_ptr(priv->fb + 16 * line_length + 8 * 2, (void *)start);
+	ut_asserteq_ptr(priv->fb + 32 * line_length + 8 * 2, (void *)end);
+
+	/* more drawing widens the region */
+	vidconsole_set_row(con, 3, 0);
+	ut_assert(video_get_damage(dev, &start, &end));
+	ut_asserteq_ptr(priv->fb + 16 * line_length + 8 * 2, (void *)start);
+	ut_asserteq_ptr(priv->fb + 64 * line_length, (void *)end);
+
+	/* syncing leaves nothing more to do */
+	ut_assertok(video_sync(dev, false));
+	ut_assert(!video_get_damage(dev, &start, &end));
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
 static int dm_test_video_text_12x22(struct unit_test_state *uts)
 {
 	struct udevice *dev, *con;
@@ -563,6 +604,30 @@ static int dm_test_video_truetype(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_truetype, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
 
+/* Test that redrawing TrueType text from the glyph cache is unchanged */
+static int dm_test_video_truetype_redraw(struct unit_test_state *uts)
+{
+	struct vidconsole_priv *vc_priv;
+	struct udevice *dev, *con;
+	const char *test_string = "Criticism may not be agreeable, but it is necessary. It fulfils the same function as pain in the human body. It calls attention to an unhealthy state of things. Some see private enterprise as a predatory target to be shot, others as a cow to be milked, but few are those who see it as a sturdy horse pulling the wagon. The \aprice OF\b\bof greatness\n\tis responsibility.\n\nBye";
+
+	ut_assertok(video_get_nologo(uts, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	vc_priv = dev_get_uclass_priv(con);
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(12174, compress_frame_buffer(uts, dev));
+
+	/* the second time, every glyph comes from the cache */
+	video_clear(dev);
+	vidconsole_set_cursor_pos(con, 0, 0);
+	vc_priv->last_ch = 0;
+	vidconsole_put_string(con, test_string);
+	ut_asserteq(12174, compress_frame_buffer(uts, dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_redraw, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
 /* Test scrolling TrueType console */
 static int dm_test_video_truetype_scroll(struct unit_test_state *uts)
 {
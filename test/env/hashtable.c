@@ -124,3 +124,87 @@ static int env_test_htab_deletes(struct unit_test_state *uts)
 }
 
 ENV_TEST(env_test_htab_deletes, 0);
+
+/* Check that a diff import only touches changed and missing variables */
+static int env_test_htab_import_diff(struct unit_test_state *uts)
+{
+	static const char env1[] = "a=1\0b=2\0c=3\0";
+	static const char env2[] = "a=1\0c=4\0d=5\0";
+	struct hsearch_data htab;
+	struct env_entry item, *ritem, *a;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, himport_r(&htab, env1, sizeof(env1), '\0', 0, 0, 0,
+				 NULL));
+
+	item.key = "a";
+	item.data = NULL;
+	ut_assert(hsearch_r(item, ENV_FIND, &a, &htab, 0));
+
+	ut_asserteq(1, himport_r(&htab, env2, sizeof(env2), '\0', H_DIFF, 0,
+				 0, NULL));
+	ut_asserteq(3, htab.filled);
+
+	/* Unchanged variables keep their entry */
+	ut_assert(hsearch_r(item, ENV_FIND, &ritem, &htab, 0));
+	ut_asserteq_ptr(a, ritem);
+	ut_asserteq_str("1", ritem->data);
+
+	item.key = "b";
+	ut_asserteq(0, hsearch_r(item, ENV_FIND, &ritem, &htab, 0));
+
+	item.key = "c";
+	ut_assert(hsearch_r(item, ENV_FIND, &ritem, &htab, 0));
+	ut_asserteq_str("4", ritem->data);
+
+	item.key = "d";
+	ut_assert(hsearch_r(item, ENV_FIND, &ritem, &htab, 0));
+	ut_asserteq_str("5", ritem->data);
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_import_diff, 0);
+
+/* Refuse to change or delete "c" and "e" */
+static int htab_test_change_ok(const struct env_entry *item,
+			       const char *newval, enum env_op op, int flag)
+{
+	return !strcmp(item->key, "c") || !strcmp(item->key, "e");
+}
+
+/* Check that a diff import keeps variables it may not change */
+static int env_test_htab_import_diff_protected(struct unit_test_state *uts)
+{
+	static const char env1[] = "a=1\0c=3\0e=5\0";
+	static const char env2[] = "a=1\0c=4\0";
+	struct hsearch_data htab;
+	struct env_entry item, *ritem;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, himport_r(&htab, env1, sizeof(env1), '\0', 0, 0, 0,
+				 NULL));
+	htab.change_ok = htab_test_change_ok;
+
+	ut_asserteq(1, himport_r(&htab, env2, sizeof(env2), '\0', H_DIFF, 0,
+				 0, NULL));
+	ut_asserteq(3, htab.filled);
+
+	/* The rejected update leaves the old value in place */
+	item.key = "c";
+	item.data = NULL;
+	ut_assert(hsearch_r(item, ENV_FIND, &ritem, &htab, 0));
+	ut_asserteq_str("3", ritem->data);
+
+	/* A protected variable is not dropped, even though it is not listed */
+	item.key = "e";
+	ut_assert(hsearch_r(item, ENV_FIND, &ritem, &htab, 0));
+	ut_asserteq_str("5", ritem->data);
+
+	htab.change_ok = NULL;
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_import_diff_protected, 0);
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for looking up symbols in the built-in symbol table
+ */
+
+#include <common.h>
+#include <abuf.h>
+#include <kallsyms.h>
+#include <asm/global_data.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Test finding the function containing an address */
+static int lib_test_kallsyms(struct unit_test_state *uts)
+{
+	/* a name starting with hex digits, which must not be read as such */
+	ulong addr = (ulong)abuf_init - gd->reloc_off;
+	ulong base, end;
+	const char *name;
+
+	name = symbol_lookup_range(addr + 1, &base, &end);
+	ut_assertnonnull(name);
+	ut_asserteq_str("abuf_init", name);
+	ut_asserteq(addr, base);
+	ut_assert(end > addr + 1);
+
+	/* the next symbol starts where this one ends */
+	name = symbol_lookup(end, &base);
+	ut_assertnonnull(name);
+	ut_asserteq(end, base);
+	ut_assert(strcmp("abuf_init", name));
+
+	return 0;
+}
+LIB_TEST(lib_test_kallsyms, 0);
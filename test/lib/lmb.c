@@ -743,10 +743,54 @@ static int lib_test_lmb_max_regions(struct unit_test_state *uts)
 
 	return 0;
 }
-#endif
 
 DM_TEST(lib_test_lmb_max_regions,
 	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#else
+static int lib_test_lmb_grow_regions(struct unit_test_state *uts)
+{
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t ram_size = 0x20000000;
+	const phys_size_t blk_size = 0x10000;
+	const int count = CONFIG_LMB_RESERVED_REGIONS * 4;
+	struct lmb lmb;
+	int ret, i;
+
+	lmb_init(&lmb);
+	ut_asserteq(lmb.reserved.max, CONFIG_LMB_RESERVED_REGIONS);
+
+	ret = lmb_add(&lmb, ram, ram_size);
+	ut_asserteq(ret, 0);
+
+	/* reserve every other block, from the top down */
+	for (i = count - 1; i >= 0; i--) {
+		ret = lmb_reserve(&lmb, ram + 2 * i * blk_size, blk_size);
+		ut_asserteq(ret, 0);
+	}
+	ut_asserteq(lmb.reserved.cnt, count);
+	ut_assert(lmb.reserved.max >= count);
+
+	for (i = 0; i < count; i++)
+		ut_asserteq(lmb.reserved.region[i].base,
+			    ram + 2 * i * blk_size);
+
+	/* the gaps can still be found */
+	ut_asserteq(lmb_is_reserved(&lmb, ram + 3 * blk_size), 0);
+	ut_asserteq(lmb_is_reserved(&lmb, ram + 4 * blk_size), 1);
+	ut_asserteq(lmb_get_free_size(&lmb, ram + blk_size), blk_size);
+
+	/* the heap arrays are freed and the initial ones are used again */
+	lmb_uninit(&lmb);
+	ut_asserteq(lmb.reserved.cnt, 0);
+	ut_asserteq(lmb.reserved.max, CONFIG_LMB_RESERVED_REGIONS);
+	ut_asserteq_ptr(lmb.reserved.region, lmb.reserved_regions);
+
+	return 0;
+}
+
+DM_TEST(lib_test_lmb_grow_regions,
+	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+#endif
 
 static int lib_test_lmb_flags(struct unit_test_state *uts)
 {
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the sampling profiler
+ */
+
+#include <common.h>
+#include <bootm.h>
+#include <profile.h>
+#include <linux/errno.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Check that the profiler is stopped before control leaves U-Boot */
+static int lib_test_profile_exit(struct unit_test_state *uts)
+{
+	ut_assertok(profile_start(1000));
+	ut_asserteq(-EBUSY, profile_show(0));
+
+	/* used by bootm and by ExitBootServices() */
+	bootm_disable_interrupts();
+	ut_assertok(profile_show(0));
+
+	return 0;
+}
+LIB_TEST(lib_test_profile_exit, UT_TESTF_CONSOLE_REC);
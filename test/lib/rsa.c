@@ -13,6 +13,8 @@
 #include <test/test.h>
 #include <test/ut.h>
 #include <u-boot/rsa.h>
+#include <u-boot/rsa-mod-exp.h>
+#include <u-boot/sha256.h>
 
 #ifdef CONFIG_RSA_VERIFY_WITH_PKEY
 /*
@@ -203,4 +205,106 @@ static int lib_rsa_verify_invalid(struct unit_test_state *uts)
 }
 
 LIB_TEST(lib_rsa_verify_invalid, 0);
+
+/**
+ * lib_rsa_verify_key_changed() - unit test for rsa_verify()
+ *
+ * Test that rsa_verify() notices when the contents of a key it has seen
+ * before are changed, even though the key is at the same address
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_verify_key_changed(struct unit_test_state *uts)
+{
+	struct image_sign_info info;
+	struct image_region reg;
+	unsigned char ctmp;
+	int ret;
+
+	memset(&info, '\0', sizeof(info));
+	info.name = "sha256,rsa2048";
+	info.padding = image_get_padding_algo("pkcs-1.5");
+	info.checksum = image_get_checksum_algo("sha256,rsa2048");
+	info.crypto = image_get_crypto_algo(info.name);
+
+	info.key = public_key;
+	info.keylen = public_key_len;
+
+	reg.data = data_raw;
+	reg.size = data_raw_len;
+	ret = rsa_verify(&info, &reg, 1, data_enc, data_enc_len);
+	ut_assertf(ret == 0, "verification unexpectedly failed (%d)\n", ret);
+
+	/* corrupt the modulus */
+	ctmp = public_key[20];
+	public_key[20] ^= 0x5a;
+	ret = rsa_verify(&info, &reg, 1, data_enc, data_enc_len);
+	public_key[20] = ctmp;
+	ut_assertf(ret != 0, "verification unexpectedly succeeded\n");
+
+	ret = rsa_verify(&info, &reg, 1, data_enc, data_enc_len);
+	ut_assertf(ret == 0, "verification unexpectedly failed (%d)\n", ret);
+
+	return CMD_RET_SUCCESS;
+}
+
+LIB_TEST(lib_rsa_verify_key_changed, 0);
+
+/* Public exponents to try, with the SHA256 of data_enc ^ exponent mod n */
+static const struct {
+	u64 exponent;
+	u8 digest[SHA256_SUM_LEN];
+} rsa_exp_vectors[] = {
+	{ 3, {
+		0xc1, 0xfb, 0x46, 0x4e, 0xed, 0xc8, 0x7b, 0xa8, 0xff, 0x7c,
+		0xc0, 0x53, 0x65, 0xa1, 0xd9, 0x96, 0xbf, 0x69, 0x69, 0x04,
+		0x5e, 0x82, 0xa7, 0x11, 0xac, 0x49, 0x86, 0x78, 0xa0, 0x1d,
+		0xde, 0x64 } },
+	/* between 2^20 and 2^32, so the sliding window is used */
+	{ 0xb3c9f1e5, {
+		0x3f, 0x7a, 0xde, 0xef, 0xf3, 0xd4, 0x7c, 0xec, 0x9e, 0x9e,
+		0x80, 0x3c, 0x82, 0xdf, 0x7c, 0x87, 0x2a, 0xec, 0xee, 0x57,
+		0xa0, 0x66, 0x6a, 0x6e, 0x56, 0x2c, 0x61, 0xc0, 0x7f, 0xb0,
+		0xf9, 0xf4 } },
+	/* above 2^32 */
+	{ 0x5a3c96e2d4b71f03ULL, {
+		0xa9, 0x7a, 0x40, 0x16, 0xd7, 0xa1, 0x09, 0xf8, 0x2a, 0xbd,
+		0x69, 0x5e, 0x5b, 0x6e, 0x3f, 0x61, 0xa4, 0xc1, 0x43, 0x03,
+		0x7e, 0xac, 0x7b, 0x6f, 0xfe, 0x3c, 0xd4, 0xa9, 0x9a, 0xe6,
+		0x26, 0x78 } },
+};
+
+/**
+ * lib_rsa_mod_exp_sw() - unit test for rsa_mod_exp_sw()
+ *
+ * Test rsa_mod_exp_sw() against known answers for public exponents other
+ * than 65537, including some which need more than 32 bits
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_rsa_mod_exp_sw(struct unit_test_state *uts)
+{
+	u8 out[256], digest[SHA256_SUM_LEN];
+	struct key_prop *prop;
+	fdt64_t exp;
+	int i;
+
+	ut_assertok(rsa_gen_key_prop(public_key, public_key_len, &prop));
+	ut_asserteq(sizeof(exp), prop->exp_len);
+	for (i = 0; i < ARRAY_SIZE(rsa_exp_vectors); i++) {
+		exp = cpu_to_fdt64(rsa_exp_vectors[i].exponent);
+		memcpy((void *)prop->public_exponent, &exp, sizeof(exp));
+		ut_assertok(rsa_mod_exp_sw(data_enc, data_enc_len, prop, out));
+		sha256_csum_wd(out, sizeof(out), digest, 0);
+		ut_asserteq_mem(rsa_exp_vectors[i].digest, digest,
+				SHA256_SUM_LEN);
+	}
+	rsa_free_key_prop(prop);
+
+	return CMD_RET_SUCCESS;
+}
+
+LIB_TEST(lib_rsa_mod_exp_sw, 0);
 #endif /* RSA_VERIFY_WITH_PKEY */
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for hot-path event counters
+ */
+
+#include <common.h>
+#include <stat.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+STAT_COUNTER_DEFINE(test, count);
+STAT_HIST_DEFINE(test, hist);
+
+static int lib_test_stat_hist_bucket(struct unit_test_state *uts)
+{
+	ut_asserteq(0, stat_hist_bucket(0));
+	ut_asserteq(1, stat_hist_bucket(1));
+	ut_asserteq(2, stat_hist_bucket(2));
+	ut_asserteq(2, stat_hist_bucket(3));
+	ut_asserteq(3, stat_hist_bucket(4));
+	ut_asserteq(10, stat_hist_bucket(1023));
+	ut_asserteq(11, stat_hist_bucket(1024));
+	ut_asserteq(STAT_HIST_BUCKETS - 1, stat_hist_bucket(1 << 20));
+	ut_asserteq(STAT_HIST_BUCKETS - 1, stat_hist_bucket(~0UL));
+
+	return 0;
+}
+LIB_TEST(lib_test_stat_hist_bucket, 0);
+
+static int lib_test_stat(struct unit_test_state *uts)
+{
+	struct stat_entry *entry;
+
+	stat_reset("test");
+	STAT_INC(test, count);
+	STAT_ADD(test, count, 41);
+	STAT_HIST_ADD(test, hist, 0);
+	STAT_HIST_ADD(test, hist, 512);
+	STAT_HIST_ADD(test, hist, 1000);
+
+	entry = ll_entry_get(struct stat_entry, test_count, stat);
+	ut_asserteq_str("test", entry->subsys);
+	ut_asserteq_str("count", entry->name);
+	ut_asserteq(STAT_COUNTER, entry->type);
+	ut_asserteq(42, entry->data[0]);
+
+	entry = ll_entry_get(struct stat_entry, test_hist, stat);
+	ut_asserteq(STAT_HIST, entry->type);
+	ut_asserteq(1, entry->data[0]);
+	ut_asserteq(2, entry->data[10]);
+
+	console_record_reset_enable();
+	stat_show("test");
+	ut_assert_nextline("Subsys   Name                        Value");
+	ut_assert_nextline("test     count                          42");
+	ut_assert_nextline("test     hist                            3 samples");
+	ut_assert_nextline("                             0                      1");
+	ut_assert_nextline("                             < 1024                 2");
+	ut_assert_console_end();
+
+	/* resetting another subsystem leaves these alone */
+	stat_reset("other");
+	ut_asserteq(42, stat_test_count[0]);
+
+	stat_reset("test");
+	ut_asserteq(0, stat_test_count[0]);
+	ut_asserteq(0, stat_test_hist[10]);
+
+	return 0;
+}
+LIB_TEST(lib_test_stat, UT_TESTF_CONSOLE_REC);
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Test the log ring buffer
+ */
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <test/log.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <vsprintf.h>
+
+static int ring_add(struct log_rec *rec, const char *fmt, ...)
+{
+	va_list args;
+	int ret;
+
+	va_start(args, fmt);
+	ret = log_ring_add(rec, fmt, args);
+	va_end(args);
+
+	return ret;
+}
+
+/* Test that the ring keeps the newest records, in order, when it wraps */
+static int log_test_ring_wrap(struct unit_test_state *uts)
+{
+	struct log_rec rec = {
+		.cat = LOGC_ARCH,
+		.level = LOGL_INFO,
+		.file = __FILE__,
+		.line = __LINE__,
+		.func = __func__,
+	};
+	/* each record takes 40 bytes, so this goes round more than twice */
+	const int count = CONFIG_LOG_RING_SIZE / 40 * 2 + 1;
+	char *buf, *line, *next;
+	int i, len, seq, found;
+
+	for (i = 0; i < count; i++)
+		ut_assertok(ring_add(&rec, "ring %d\n", i));
+
+	len = log_ring_export(NULL, 0);
+	buf = malloc(len + 1);
+	ut_assertnonnull(buf);
+	ut_asserteq(len, log_ring_export(buf, len + 1));
+	ut_asserteq(len, strlen(buf));
+	ut_assertnonnull(strstr(buf, "records lost"));
+
+	/* our records must be consecutive and end with the last one */
+	seq = -1;
+	found = 0;
+	for (line = buf; *line; line = next + 1) {
+		next = strchr(line, '\n');
+		ut_assertnonnull(next);
+		line = strstr(line, "INFO.arch log_test_ring_wrap() ring ");
+		if (!line || line > next)
+			continue;
+		i = dectoul(strrchr(line, ' ') + 1, NULL);
+		if (seq != -1)
+			ut_asserteq(seq + 1, i);
+		seq = i;
+		found++;
+	}
+	free(buf);
+	ut_asserteq(count - 1, seq);
+	ut_assert(found > CONFIG_LOG_RING_SIZE / 40 / 2);
+	ut_assert(found < count);
+
+	return 0;
+}
+LOG_TEST(log_test_ring_wrap);
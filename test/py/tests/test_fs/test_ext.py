@@ -353,3 +353,41 @@ class TestFsExt(object):
             assert(str2fat(MANGLE_FILE) in ''.join(output))
 
             assert_fs_integrity(fs_type, fs_img)
+
+    def test_fs_ext13(self, u_boot_console, fs_obj_ext):
+        """
+        Test Case 13 - write a file into fragmented free space
+        """
+        fs_type,fs_img,md5val = fs_obj_ext
+        with u_boot_console.log.section('Test Case 13 - write into holes'):
+            # Test Case 13a - Leave holes the size of MIN_FILE
+            output = u_boot_console.run_command_list([
+                'host bind 0 %s' % fs_img,
+                '%sload host 0:0 %x /%s' % (fs_type, ADDR, MIN_FILE)])
+            for i in range(0, 8):
+                output = u_boot_console.run_command(
+                    '%swrite host 0:0 %x /dir1/HOLE_%d $filesize'
+                    % (fs_type, ADDR, i))
+                assert('20480 bytes written' in output)
+            for i in range(0, 8, 2):
+                output = u_boot_console.run_command(
+                    '%srm host 0:0 /dir1/HOLE_%d' % (fs_type, i))
+
+            # Test Case 13b - Write a file spanning several holes
+            output = u_boot_console.run_command_list([
+                '%sload host 0:0 %x /%s' % (fs_type, ADDR + 0x5000, MIN_FILE),
+                '%sload host 0:0 %x /%s' % (fs_type, ADDR + 0xa000, MIN_FILE),
+                'md5sum %x 0xf000' % ADDR,
+                '%swrite host 0:0 %x /dir1/%s.w13 0xf000'
+                    % (fs_type, ADDR, MIN_FILE)])
+            assert('61440 bytes written' in ''.join(output))
+            md5 = re.search('==> ([0-9a-f]{32})', ''.join(output)).group(1)
+
+            # Test Case 13c - Check md5 of file content
+            output = u_boot_console.run_command_list([
+                'mw.b %x 00 0xf000' % ADDR,
+                '%sload host 0:0 %x /dir1/%s.w13' % (fs_type, ADDR, MIN_FILE),
+                'md5sum %x $filesize' % ADDR,
+                'setenv filesize'])
+            assert(md5 in ''.join(output))
+            assert_fs_integrity(fs_type, fs_img)
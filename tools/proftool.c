@@ -286,6 +286,7 @@ static void usage(void)
 		"Commands\n"
 		"   dump-ftrace\t\tDump out records in ftrace format for use by trace-cmd\n"
 		"   dump-flamegraph\tWrite a file for use with flamegraph.pl\n"
+		"   dump-chrome\t\tWrite Chrome trace-event JSON (chrome://tracing)\n"
 		"\n"
 		"Options:\n"
 		"   -c <cfg>\tSpecify config file\n"
@@ -1871,6 +1872,54 @@ static int make_flamegraph(FILE *fout, enum out_format_t out_format)
 	return 0;
 }
 
+/**
+ * make_chrome() - Write the trace as Chrome trace-event JSON
+ *
+ * Each function entry and exit becomes a begin ('B') or end ('E') event on a
+ * single track, so that the viewer (chrome://tracing or ui.perfetto.dev) can
+ * show the call nesting over time. Timestamps are already in microseconds,
+ * which is what the format expects.
+ *
+ * @fout: Output file
+ * Returns: 0 on success, -1 on error
+ */
+static int make_chrome(FILE *fout)
+{
+	int missing_count = 0, skip_count = 0;
+	struct trace_call *call;
+	int i;
+
+	fprintf(fout, "{\"traceEvents\":[\n");
+	fprintf(fout, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"U-Boot\"}},\n",
+		TRACE_PID);
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		bool entry = TRACE_CALL_TYPE(call) == FUNCF_ENTRY;
+		ulong timestamp = call->flags & FUNCF_TIMESTAMP_MASK;
+		struct func_info *func;
+
+		func = find_func_by_offset(call->func);
+		if (!func) {
+			warn("Cannot find function at %lx\n",
+			     text_offset + call->func);
+			missing_count++;
+			continue;
+		}
+		if (!(func->flags & FUNCF_TRACE)) {
+			skip_count++;
+			continue;
+		}
+		fprintf(fout, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":%d,\"tid\":0},\n",
+			func->name, entry ? 'B' : 'E', timestamp, TRACE_PID);
+	}
+	/* the format does not allow a trailing comma, so end with an empty event */
+	fprintf(fout, "{}],\"displayTimeUnit\":\"ms\"}\n");
+
+	info("chrome: %d functions not found, %d excluded\n", missing_count,
+	     skip_count);
+
+	return 0;
+}
+
 /**
  * prof_tool() - Performs requested action
  *
@@ -1928,6 +1977,17 @@ static int prof_tool(int argc, char *const argv[],
 			}
 			err = make_flamegraph(fout, out_format);
 			fclose(fout);
+		} else if (!strcmp(cmd, "dump-chrome")) {
+			FILE *fout;
+
+			fout = fopen(out_fname, "w");
+			if (!fout) {
+				fprintf(stderr, "Cannot write file '%s'\n",
+					out_fname);
+				return -1;
+			}
+			err = make_chrome(fout);
+			fclose(fout);
 		} else {
 			warn("Unknown command '%s'\n", cmd);
 		}